@@ -0,0 +1,42 @@
+#include "pch.hpp"
+#include "fixed_timestep.hpp"
+
+using fts = bklib::fixed_timestep;
+
+//==============================================================================
+//!
+//==============================================================================
+unsigned fts::update() {
+    return update(clock::now());
+}
+
+unsigned fts::update(time_point const now) {
+    BK_ASSERT(now >= last_);
+
+    accumulator_ += now - last_;
+    last_ = now;
+
+    unsigned n = 0;
+    for (; n < max_steps_ && accumulator_ >= step_; ++n) {
+        accumulator_ -= step_;
+        sim_.update(sim_.now() + step_);
+    }
+
+    steps_ += n;
+
+    //too far behind to catch up; keep only the partial step.
+    if (accumulator_ >= step_) {
+        auto const left = accumulator_ % step_;
+        dropped_    += accumulator_ - left;
+        accumulator_ = left;
+    }
+
+    return n;
+}
+//==============================================================================
+//!
+//==============================================================================
+double fts::alpha() const BK_NOEXCEPT {
+    return static_cast<double>(accumulator_.count())
+         / static_cast<double>(step_.count());
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "config.hpp"
+#include "types.hpp"
+#include "assert.hpp"
+#include "timekeeper.hpp"
+
+namespace bklib {
+
+//==============================================================================
+//! Fixed timestep driver.
+//!
+//! Real time is accumulated by update() and spent in whole steps; each step
+//! advances the time of simulation() by exactly one step, so its events see
+//! the same sequence of times whatever the frame rate. At most max_steps are
+//! run per update; time beyond that is dropped rather than carried, so a slow
+//! frame costs a bounded amount of simulation. The time left over is exposed
+//! as alpha() for interpolating between the last two steps when rendering.
+//==============================================================================
+class fixed_timestep {
+public:
+    using clock      = timekeeper::clock;
+    using duration   = timekeeper::duration;
+    using time_point = timekeeper::time_point;
+
+    //! @param step      The simulated time per step; also the resolution of
+    //!                  simulation().
+    //! @param max_steps The most steps run by one update().
+    template <typename T>
+    explicit fixed_timestep(T const step, unsigned const max_steps = 5)
+      : step_ {std::chrono::duration_cast<duration>(step)}
+      , max_steps_ {max_steps}
+      , sim_ {step_}
+      , last_ {sim_.now()}
+      , accumulator_ {duration::zero()}
+      , steps_ {0}
+      , dropped_ {duration::zero()}
+    {
+        BK_ASSERT(step_.count() > 0);
+        BK_ASSERT(max_steps_ > 0);
+    }
+
+    //! The timekeeper for simulation events, updated once per step.
+    timekeeper&       simulation()       BK_NOEXCEPT { return sim_; }
+    timekeeper const& simulation() const BK_NOEXCEPT { return sim_; }
+
+    //! Accumulate the time since the last update and run the steps it covers.
+    //! @returns The number of steps run.
+    unsigned update();
+
+    //! As above, at the given time.
+    //! @pre now is not earlier than the last update.
+    unsigned update(time_point now);
+
+    //! The fraction of a step accumulated but not yet run, in [0, 1).
+    double alpha() const BK_NOEXCEPT;
+
+    duration step()      const BK_NOEXCEPT { return step_; }
+    unsigned max_steps() const BK_NOEXCEPT { return max_steps_; }
+
+    //! The total number of steps run.
+    uint64_t steps() const BK_NOEXCEPT { return steps_; }
+
+    //! The total time dropped by updates which hit max_steps.
+    duration dropped() const BK_NOEXCEPT { return dropped_; }
+private:
+    duration   step_;
+    unsigned   max_steps_;
+    timekeeper sim_;
+
+    time_point last_;        //!< the real time of the last update.
+    duration   accumulator_; //!< real time not yet simulated.
+    uint64_t   steps_;
+    duration   dropped_;
+};
+
+} //namespace bklib
@@ -0,0 +1,372 @@
+#include "pch.hpp"
+
+#include "bitboard.hpp"
+
+using bitboard = tez::bitboard;
+using word_t   = bitboard::word_t;
+
+namespace {
+//==============================================================================
+//! Portable population count.
+//==============================================================================
+size_t popcount(word_t x) BK_NOEXCEPT {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<size_t>((x * 0x0101010101010101ULL) >> 56);
+}
+//==============================================================================
+//! For each bit x of word i in @c row, the bit at x + 1.
+//==============================================================================
+word_t bits_east_of(word_t const* row, size_t const i, size_t const n) BK_NOEXCEPT {
+    auto const next = (i + 1 < n) ? row[i + 1] : word_t {0};
+    return (row[i] >> 1) | (next << 63);
+}
+//==============================================================================
+//! For each bit x of word i in @c row, the bit at x - 1.
+//==============================================================================
+word_t bits_west_of(word_t const* row, size_t const i) BK_NOEXCEPT {
+    auto const prev = (i > 0) ? row[i - 1] : word_t {0};
+    return (row[i] << 1) | (prev >> 63);
+}
+//==============================================================================
+//! Bitwise adders; 64 independent sums at once.
+//==============================================================================
+void half_add(word_t const a, word_t const b, word_t& sum, word_t& carry) BK_NOEXCEPT {
+    sum   = a ^ b;
+    carry = a & b;
+}
+
+void full_add(word_t const a, word_t const b, word_t const c, word_t& sum, word_t& carry) BK_NOEXCEPT {
+    auto const t = a ^ b;
+    sum   = t ^ c;
+    carry = (a & b) | (t & c);
+}
+//==============================================================================
+//! Apply f(west, center, east) to every word of @c src giving @c out.
+//==============================================================================
+template <typename F>
+void horizontal(
+    std::vector<word_t> const& src
+  , std::vector<word_t>&       out
+  , size_t const               stride
+  , F                          f
+) {
+    auto const rows = stride ? src.size() / stride : 0;
+
+    for (size_t y = 0; y < rows; ++y) {
+        auto const r = src.data() + y * stride;
+        auto const o = out.data() + y * stride;
+
+        for (size_t i = 0; i < stride; ++i) {
+            o[i] = f(bits_west_of(r, i), r[i], bits_east_of(r, i, stride));
+        }
+    }
+}
+} //namespace
+
+//==============================================================================
+tez::tile_property_table const& tez::tile_property_table::get_default() {
+    static tile_property_table const table = [] {
+        using p = tile_property;
+        using t = tile_type;
+
+        tile_property_table result;
+        result.set(t::empty,   p::opaque)
+              .set(t::floor,   p::passable)
+              .set(t::wall,    p::opaque)
+              .set(t::ceiling, p::opaque)
+              .set(t::door,    p::passable)
+              .set(t::door,    p::opaque);
+
+        return result;
+    }();
+
+    return table;
+}
+
+//==============================================================================
+bitboard::bitboard(index_t const w, index_t const h, bool const value)
+  : width_{w}
+  , height_{h}
+  , stride_{(w + word_bits - 1) / word_bits}
+  , last_mask_{(w % word_bits) ? ((word_t {1} << (w % word_bits)) - 1) : ~word_t {0}}
+  , words_(stride_ * h, value ? ~word_t {0} : word_t {0})
+{
+    clear_padding();
+}
+
+bitboard::bitboard(bitboard&& other)
+  : width_{other.width_}
+  , height_{other.height_}
+  , stride_{other.stride_}
+  , last_mask_{other.last_mask_}
+  , words_(std::move(other.words_))
+{
+}
+
+bitboard& bitboard::operator=(bitboard&& rhs) {
+    rhs.swap(*this);
+    return *this;
+}
+
+void bitboard::swap(bitboard& other) {
+    using std::swap;
+    swap(width_,     other.width_);
+    swap(height_,    other.height_);
+    swap(stride_,    other.stride_);
+    swap(last_mask_, other.last_mask_);
+    swap(words_,     other.words_);
+}
+
+bitboard::bitboard(
+    const_grid_view<tile_type> const types
+  , tile_property              const p
+  , tile_property_table const&       table
+)
+  : bitboard(types.width(), types.height())
+{
+    for (auto const row : types.rows()) {
+        auto const out = this->row(row.y);
+
+        //build a word at a time from the byte plane.
+        for (size_t i = 0; i < stride_; ++i) {
+            auto const first = i * word_bits;
+            auto const last  = std::min(first + word_bits, width_);
+
+            word_t w = 0;
+            for (auto x = first; x < last; ++x) {
+                w |= word_t {table.test(row.values[x], p)} << (x - first);
+            }
+
+            out[i] = w;
+        }
+    }
+}
+
+bitboard bitboard::clone() const {
+    bitboard result {width_, height_};
+    result.words_ = words_;
+    return result;
+}
+
+//==============================================================================
+void bitboard::clear_padding() {
+    if (!stride_) return;
+
+    for (size_t y = 0; y < height_; ++y) {
+        words_[y * stride_ + stride_ - 1] &= last_mask_;
+    }
+}
+
+void bitboard::fill(bool const value) {
+    std::fill(std::begin(words_), std::end(words_), value ? ~word_t {0} : word_t {0});
+    clear_padding();
+}
+
+size_t bitboard::count() const BK_NOEXCEPT {
+    size_t result = 0;
+    for (auto const w : words_) result += popcount(w);
+    return result;
+}
+
+//==============================================================================
+bitboard& bitboard::operator&=(bitboard const& rhs) {
+    BK_ASSERT(width_ == rhs.width_ && height_ == rhs.height_);
+    for (size_t i = 0; i < words_.size(); ++i) words_[i] &= rhs.words_[i];
+    return *this;
+}
+
+bitboard& bitboard::operator|=(bitboard const& rhs) {
+    BK_ASSERT(width_ == rhs.width_ && height_ == rhs.height_);
+    for (size_t i = 0; i < words_.size(); ++i) words_[i] |= rhs.words_[i];
+    return *this;
+}
+
+bitboard& bitboard::operator^=(bitboard const& rhs) {
+    BK_ASSERT(width_ == rhs.width_ && height_ == rhs.height_);
+    for (size_t i = 0; i < words_.size(); ++i) words_[i] ^= rhs.words_[i];
+    return *this;
+}
+
+bitboard& bitboard::subtract(bitboard const& rhs) {
+    BK_ASSERT(width_ == rhs.width_ && height_ == rhs.height_);
+    for (size_t i = 0; i < words_.size(); ++i) words_[i] &= ~rhs.words_[i];
+    return *this;
+}
+
+bitboard& bitboard::invert() {
+    for (auto& w : words_) w = ~w;
+    clear_padding();
+    return *this;
+}
+
+//==============================================================================
+bitboard bitboard::dilate() const {
+    bitboard h {width_, height_};
+    horizontal(words_, h.words_, stride_, [](word_t w, word_t c, word_t e) {
+        return w | c | e;
+    });
+    h.clear_padding();
+
+    bitboard result {width_, height_};
+    for (size_t y = 0; y < height_; ++y) {
+        auto const above = (y > 0)           ? h.row(y - 1).data() : nullptr;
+        auto const below = (y + 1 < height_) ? h.row(y + 1).data() : nullptr;
+        auto const here  = h.row(y).data();
+        auto const out   = result.row(y).data();
+
+        for (size_t i = 0; i < stride_; ++i) {
+            out[i] = here[i]
+                   | (above ? above[i] : 0)
+                   | (below ? below[i] : 0);
+        }
+    }
+
+    return result;
+}
+
+bitboard bitboard::erode() const {
+    bitboard h {width_, height_};
+    horizontal(words_, h.words_, stride_, [](word_t w, word_t c, word_t e) {
+        return w & c & e;
+    });
+    h.clear_padding();
+
+    bitboard result {width_, height_};
+    for (size_t y = 1; y + 1 < height_; ++y) {
+        auto const above = h.row(y - 1).data();
+        auto const below = h.row(y + 1).data();
+        auto const here  = h.row(y).data();
+        auto const out   = result.row(y).data();
+
+        for (size_t i = 0; i < stride_; ++i) {
+            out[i] = here[i] & above[i] & below[i];
+        }
+    }
+
+    return result;
+}
+
+bitboard bitboard::any_neighbour() const {
+    bitboard h3 {width_, height_}; //west | center | east
+    bitboard h2 {width_, height_}; //west | east
+
+    horizontal(words_, h3.words_, stride_, [](word_t w, word_t c, word_t e) {
+        return w | c | e;
+    });
+    horizontal(words_, h2.words_, stride_, [](word_t w, word_t, word_t e) {
+        return w | e;
+    });
+    h3.clear_padding();
+    h2.clear_padding();
+
+    bitboard result {width_, height_};
+    for (size_t y = 0; y < height_; ++y) {
+        auto const above = (y > 0)           ? h3.row(y - 1).data() : nullptr;
+        auto const below = (y + 1 < height_) ? h3.row(y + 1).data() : nullptr;
+        auto const here  = h2.row(y).data();
+        auto const out   = result.row(y).data();
+
+        for (size_t i = 0; i < stride_; ++i) {
+            out[i] = here[i]
+                   | (above ? above[i] : 0)
+                   | (below ? below[i] : 0);
+        }
+    }
+
+    return result;
+}
+
+//==============================================================================
+void bitboard::step(ca_rule const rule, bitboard& out, bool const outside) const {
+    BK_ASSERT(&out != this);
+    BK_ASSERT(width_ == out.width_ && height_ == out.height_);
+
+    if (!stride_ || !height_) return;
+
+    auto const fill = outside ? ~word_t {0} : word_t {0};
+
+    //the counts n for which a cell can be set next generation, with a mask
+    //for clear (birth) and set (survive) cells.
+    struct term { word_t k[4]; word_t birth; word_t survive; };
+    std::array<term, 9> terms;
+    size_t term_count = 0;
+
+    for (unsigned n = 0; n <= 8; ++n) {
+        auto const b = (rule.birth   >> n) & 1;
+        auto const s = (rule.survive >> n) & 1;
+        if (!b && !s) continue;
+
+        auto& t = terms[term_count++];
+        for (unsigned j = 0; j < 4; ++j) {
+            t.k[j] = ((n >> j) & 1) ? ~word_t {0} : word_t {0};
+        }
+        t.birth   = b ? ~word_t {0} : word_t {0};
+        t.survive = s ? ~word_t {0} : word_t {0};
+    }
+
+    //rows above, at and below y with a sentinel word at each end; tiles
+    //outside the board, including the padding bits, are set to fill.
+    auto const n = stride_ + 2;
+    std::vector<word_t> buffer(n * 3);
+    word_t* rows[3] = {buffer.data(), buffer.data() + n, buffer.data() + n * 2};
+
+    auto const load = [&](word_t* const dest, size_t const y) {
+        if (y >= height_) {
+            std::fill(dest, dest + n, fill);
+            return;
+        }
+
+        auto const src = row(y);
+        dest[0] = fill;
+        std::copy(std::begin(src), std::end(src), dest + 1);
+        dest[n - 2] |= fill & ~last_mask_;
+        dest[n - 1] = fill;
+    };
+
+    load(rows[0], static_cast<size_t>(-1));
+    load(rows[1], 0);
+    load(rows[2], 1);
+
+    for (size_t y = 0; y < height_; ++y) {
+        auto const a = rows[0];
+        auto const c = rows[1];
+        auto const b = rows[2];
+        auto const o = out.row(y).data();
+
+        for (size_t i = 1; i <= stride_; ++i) {
+            //sum the 8 neighbours into the bit planes s0..s3.
+            word_t sa, ca, sb, cb, sc, cc;
+            full_add(bits_west_of(a, i), a[i], bits_east_of(a, i, n), sa, ca);
+            full_add(bits_west_of(b, i), b[i], bits_east_of(b, i, n), sb, cb);
+            half_add(bits_west_of(c, i), bits_east_of(c, i, n), sc, cc);
+
+            word_t s0, cd;
+            full_add(sa, sb, sc, s0, cd);
+
+            word_t t1, u1, s1, u2;
+            full_add(ca, cb, cc, t1, u1);
+            half_add(t1, cd, s1, u2);
+
+            auto const s2 = u1 ^ u2;
+            auto const s3 = u1 & u2;
+
+            auto const cell = c[i];
+
+            word_t result = 0;
+            for (size_t j = 0; j < term_count; ++j) {
+                auto const& t = terms[j];
+                auto const eq = ~((s0 ^ t.k[0]) | (s1 ^ t.k[1]) | (s2 ^ t.k[2]) | (s3 ^ t.k[3]));
+                result |= eq & ((~cell & t.birth) | (cell & t.survive));
+            }
+
+            o[i - 1] = result;
+        }
+
+        std::rotate(rows, rows + 1, rows + 3);
+        load(rows[2], y + 2);
+    }
+
+    out.clear_padding();
+}
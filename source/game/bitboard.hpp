@@ -0,0 +1,219 @@
+#pragma once
+
+#include <array>
+#include <initializer_list>
+#include <vector>
+
+#include "config.hpp"
+#include "assert.hpp"
+
+#include "tile_data.hpp"
+#include "grid2d.hpp"
+
+namespace tez {
+
+//==============================================================================
+//! Boolean properties of tiles derived from their type.
+//==============================================================================
+enum class tile_property : uint8_t {
+    passable = 1 << 0
+  , opaque   = 1 << 1
+};
+//==============================================================================
+//! Maps each tile_type to its set of tile_property flags.
+//==============================================================================
+class tile_property_table {
+public:
+    //! Empty table; no type has any property.
+    tile_property_table() BK_NOEXCEPT {
+        flags_.fill(0);
+    }
+
+    //! The standard properties for each tile_type.
+    static tile_property_table const& get_default();
+
+    tile_property_table& set(tile_type const type, tile_property const p, bool const value = true) {
+        auto& f = flags_[index_(type)];
+        auto const bit = static_cast<uint8_t>(p);
+        f = value ? (f | bit) : (f & ~bit);
+        return *this;
+    }
+
+    bool test(tile_type const type, tile_property const p) const BK_NOEXCEPT {
+        return (flags_[index_(type)] & static_cast<uint8_t>(p)) != 0;
+    }
+private:
+    static size_t index_(tile_type const type) BK_NOEXCEPT {
+        auto const i = static_cast<size_t>(type);
+        BK_ASSERT(i < static_cast<size_t>(tile_type::COUNT));
+        return i;
+    }
+
+    std::array<uint8_t, static_cast<size_t>(tile_type::COUNT)> flags_;
+};
+
+//==============================================================================
+//! A totalistic cellular automaton rule over the 8 neighbours of a cell in the
+//! B/S notation; e.g. B678/S345678 is ca_rule {{6, 7, 8}, {3, 4, 5, 6, 7, 8}}.
+//!
+//! Bit n of @c birth (@c survive) is set if a clear (set) cell with n set
+//! neighbours is set in the next generation.
+//==============================================================================
+struct ca_rule {
+    ca_rule(std::initializer_list<unsigned> b, std::initializer_list<unsigned> s)
+      : birth{0}, survive{0}
+    {
+        for (auto const n : b) { BK_ASSERT(n <= 8); birth   = static_cast<uint16_t>(birth   | (1u << n)); }
+        for (auto const n : s) { BK_ASSERT(n <= 8); survive = static_cast<uint16_t>(survive | (1u << n)); }
+    }
+
+    //! B678/S345678; smooths noise into caves with set cells as rock.
+    static ca_rule cave() {
+        return ca_rule {{6, 7, 8}, {3, 4, 5, 6, 7, 8}};
+    }
+
+    uint16_t birth;
+    uint16_t survive;
+};
+
+//==============================================================================
+//! A 2D grid of bits packed 64 per word, row by row; each row starts on a
+//! word boundary. Bits past the width of a row are always 0.
+//!
+//! Whole board operations work on a word (64 tiles) at a time; neighbour
+//! operations are implemented with shifts and masks. Tiles outside the board
+//! are treated as 0.
+//==============================================================================
+class bitboard {
+public:
+    using word_t  = uint64_t;
+    using index_t = size_t;
+    using index   = index2d<index_t>;
+
+    static size_t const word_bits = 64;
+
+    //No implicit copies
+    bitboard(bitboard const&) = delete;
+    bitboard& operator=(bitboard const&) = delete;
+
+    bitboard(bitboard&& other);
+    bitboard& operator=(bitboard&& rhs);
+    void swap(bitboard& other);
+
+    bitboard(index_t w, index_t h, bool value = false);
+
+    //! Set each bit where the tile type of @c src has the property @c p.
+    template <typename Layout>
+    bitboard(
+        grid2d<tile_data, Layout> const& src
+      , tile_property                    p
+      , tile_property_table const&       table = tile_property_table::get_default()
+    )
+      : bitboard(src.width(), src.height())
+    {
+        for (auto const& tile : src) {
+            if (table.test(tile.value.type, p)) set(tile.i);
+        }
+    }
+
+    //! Set each bit where the tile type in @c types has the property @c p.
+    bitboard(
+        const_grid_view<tile_type> types
+      , tile_property              p
+      , tile_property_table const& table = tile_property_table::get_default()
+    );
+
+    //! Explicit copy.
+    bitboard clone() const;
+
+    size_t width()          const BK_NOEXCEPT { return width_; }
+    size_t height()         const BK_NOEXCEPT { return height_; }
+    size_t size()           const BK_NOEXCEPT { return width_ * height_; }
+    size_t words_per_row()  const BK_NOEXCEPT { return stride_; }
+
+    size_t mem_size() const BK_NOEXCEPT {
+        return sizeof(bitboard) + words_.size() * sizeof(word_t);
+    }
+
+    bool is_valid(index i) const BK_NOEXCEPT {
+        return (i.x < width_) && (i.y < height_);
+    }
+
+    bool operator[](index i) const BK_NOEXCEPT {
+        BK_ASSERT(is_valid(i));
+        return ((word_(i) >> (i.x % word_bits)) & 1) != 0;
+    }
+
+    void set(index i, bool const value = true) BK_NOEXCEPT {
+        BK_ASSERT(is_valid(i));
+        auto const bit = word_t {1} << (i.x % word_bits);
+        auto& w = word_(i);
+        w = value ? (w | bit) : (w & ~bit);
+    }
+
+    void reset(index i) BK_NOEXCEPT { set(i, false); }
+
+    //! Set every bit to @c value.
+    void fill(bool value);
+
+    //! @returns The number of set bits.
+    size_t count() const BK_NOEXCEPT;
+
+    bklib::span<word_t> row(size_t const y) BK_NOEXCEPT {
+        BK_ASSERT(y < height_);
+        return {words_.data() + y * stride_, stride_};
+    }
+
+    bklib::span<word_t const> row(size_t const y) const BK_NOEXCEPT {
+        BK_ASSERT(y < height_);
+        return {words_.data() + y * stride_, stride_};
+    }
+
+    //--------------------------------------------------------------------------
+    // Element-wise operations; @pre the dimensions of @c rhs match.
+    //--------------------------------------------------------------------------
+    bitboard& operator&=(bitboard const& rhs);
+    bitboard& operator|=(bitboard const& rhs);
+    bitboard& operator^=(bitboard const& rhs);
+    //! a & ~b
+    bitboard& subtract(bitboard const& rhs);
+    //! ~a
+    bitboard& invert();
+
+    //--------------------------------------------------------------------------
+    // Neighbourhood operations over the 8 surrounding tiles.
+    //--------------------------------------------------------------------------
+    //! Set where any tile of the 3x3 block centered on the tile is set.
+    bitboard dilate() const;
+    //! Set where every tile of the 3x3 block centered on the tile is set.
+    bitboard erode() const;
+    //! Set where any of the 8 neighbours (excluding the tile itself) is set.
+    bitboard any_neighbour() const;
+
+    //! Write the next generation of @c rule to @c out. The 8 neighbour counts
+    //! of 64 cells are computed at once with bitwise adders.
+    //! @param outside The value of tiles outside the board.
+    //! @pre @c out has the same dimensions and is not this board.
+    void step(ca_rule rule, bitboard& out, bool outside = false) const;
+
+    //! Clear the bits beyond the width in the last word of each row; needed
+    //! after writing whole words through row().
+    void clear_padding();
+private:
+    word_t& word_(index i) BK_NOEXCEPT {
+        return words_[i.y * stride_ + i.x / word_bits];
+    }
+
+    word_t const& word_(index i) const BK_NOEXCEPT {
+        return words_[i.y * stride_ + i.x / word_bits];
+    }
+
+    index_t width_;
+    index_t height_;
+    size_t  stride_;    //!< words per row.
+    word_t  last_mask_; //!< mask of valid bits in the last word of a row.
+
+    std::vector<word_t> words_;
+};
+
+} //namespace tez
@@ -0,0 +1,87 @@
+#include "pch.hpp"
+
+#include "chunked_map.hpp"
+
+using chunked_map = tez::chunked_map;
+
+//==============================================================================
+chunked_map::chunked_map(
+    size_t    const budget
+  , generator       gen
+  , evictor         evict
+)
+  : budget_{budget}
+  , max_chunks_{std::max<size_t>(1, budget / chunk_mem_size())}
+  , generator_{std::move(gen)}
+  , evictor_{std::move(evict)}
+{
+}
+
+//==============================================================================
+tez::tile_data& chunked_map::operator[](point const p) {
+    auto const key = key_of(p);
+    auto& c = get_chunk(key);
+
+    auto const x = static_cast<size_t>(p.x - key.x * static_cast<int>(chunk_size));
+    auto const y = static_cast<size_t>(p.y - key.y * static_cast<int>(chunk_size));
+
+    return c[{x, y}];
+}
+
+tez::tile_data const* chunked_map::find(point const p) const {
+    auto const key = key_of(p);
+    auto const it  = index_.find(hash_key_(key));
+
+    if (it == std::end(index_)) return nullptr;
+
+    auto const x = static_cast<size_t>(p.x - key.x * static_cast<int>(chunk_size));
+    auto const y = static_cast<size_t>(p.y - key.y * static_cast<int>(chunk_size));
+
+    return &it->second->data[{x, y}];
+}
+
+//==============================================================================
+chunked_map::chunk& chunked_map::get_chunk(chunk_key const key) {
+    auto const h  = hash_key_(key);
+    auto const it = index_.find(h);
+
+    //resident; move to the front.
+    if (it != std::end(index_)) {
+        lru_.splice(std::begin(lru_), lru_, it->second);
+        return it->second->data;
+    }
+
+    //make room first so that the new chunk can't be the one evicted.
+    while (lru_.size() >= max_chunks_) {
+        evict_();
+    }
+
+    lru_.emplace_front(key);
+    index_.emplace(h, std::begin(lru_));
+
+    auto& result = lru_.front().data;
+    if (generator_) generator_(key, result);
+
+    return result;
+}
+
+bool chunked_map::is_resident(chunk_key const key) const {
+    return index_.find(hash_key_(key)) != std::end(index_);
+}
+
+//==============================================================================
+void chunked_map::clear() {
+    while (!lru_.empty()) {
+        evict_();
+    }
+}
+
+void chunked_map::evict_() {
+    BK_ASSERT(!lru_.empty());
+
+    auto& victim = lru_.back();
+    if (evictor_) evictor_(victim.key, victim.data);
+
+    index_.erase(hash_key_(victim.key));
+    lru_.pop_back();
+}
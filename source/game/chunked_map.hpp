@@ -0,0 +1,161 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <functional>
+
+#include "config.hpp"
+#include "assert.hpp"
+#include "math.hpp"
+
+#include "tile_data.hpp"
+#include "grid2d.hpp"
+
+namespace tez {
+
+//==============================================================================
+//! An unbounded map made of fixed size square chunks.
+//!
+//! Chunks are created on first access and filled by an optional generator.
+//! The number of resident chunks is bounded by a memory budget; when it is
+//! exceeded the least recently used chunk is evicted and handed to an
+//! optional eviction callback (e.g. to save it). An evicted chunk is
+//! regenerated if it is accessed again.
+//!
+//! References returned by operator[] and get_chunk() are invalidated by any
+//! later access which creates a chunk.
+//==============================================================================
+class chunked_map {
+public:
+    static size_t const chunk_size = 32;
+
+    using point     = bklib::point2d<int>;
+    using rect      = bklib::axis_aligned_rect<int>;
+    using chunk     = grid2d<tile_data>;
+    using chunk_key = bklib::point2d<int>;
+
+    //! Fill a newly created chunk.
+    using generator = std::function<void (chunk_key key, chunk& c)>;
+    //! Called with each chunk before it is evicted.
+    using evictor   = std::function<void (chunk_key key, chunk& c)>;
+
+    //No implicit copies
+    chunked_map(chunked_map const&) = delete;
+    chunked_map& operator=(chunked_map const&) = delete;
+
+    //! @param budget Maximum memory in bytes used by resident chunks; at least
+    //!        one chunk is always kept.
+    explicit chunked_map(
+        size_t    budget
+      , generator gen = generator {}
+      , evictor   evict = evictor {}
+    );
+
+    //! @returns The tile at @c p; creates its chunk if required.
+    tile_data& operator[](point p);
+
+    //! @returns The tile at @c p if its chunk is resident, otherwise nullptr.
+    //! Doesn't create chunks or affect the eviction order.
+    tile_data const* find(point p) const;
+
+    //! @returns The chunk for @c key; creates it if required.
+    chunk& get_chunk(chunk_key key);
+
+    //! @returns Whether the chunk for @c key is resident.
+    bool is_resident(chunk_key key) const;
+
+    //! Stamp the non-empty tiles of @c src into the map with its top left at
+    //! @c dest_rect's top left. Works a row segment at a time; at most one
+    //! chunk is needed at once.
+    //! @param src A grid2d or grid_view of tile_data.
+    //! @pre The tiles stamped over are empty; as for map::write.
+    template <typename Grid>
+    void write(Grid const& src, rect const& dest_rect) {
+        auto const w = static_cast<int>(src.width());
+        auto const h = static_cast<int>(src.height());
+
+        for (int y = 0; y < h; ++y) {
+            auto const dy = dest_rect.top() + y;
+
+            for (int x = 0; x < w;) {
+                auto const dx   = dest_rect.left() + x;
+                auto const key  = key_of(point {dx, dy});
+                auto const lx   = dx - key.x * static_cast<int>(chunk_size);
+                auto const ly   = dy - key.y * static_cast<int>(chunk_size);
+                auto const n    = std::min(w - x, static_cast<int>(chunk_size) - lx);
+                auto&      dest = get_chunk(key);
+
+                for (int i = 0; i < n; ++i) {
+                    auto const sx = static_cast<size_t>(x + i);
+                    auto const sy = static_cast<size_t>(y);
+                    auto const& s = src[{sx, sy}];
+                    if (s.type == tile_type::empty) continue;
+
+                    auto& t = dest[{static_cast<size_t>(lx + i), static_cast<size_t>(ly)}];
+
+                    BK_ASSERT(t.type == tile_type::empty);
+                    t = s;
+                }
+
+                x += n;
+            }
+        }
+    }
+
+    //! Evict every chunk.
+    void clear();
+
+    size_t budget()          const BK_NOEXCEPT { return budget_; }
+    size_t max_chunks()      const BK_NOEXCEPT { return max_chunks_; }
+    size_t resident_chunks() const BK_NOEXCEPT { return lru_.size(); }
+
+    size_t mem_size() const BK_NOEXCEPT {
+        return sizeof(chunked_map) + resident_chunks() * chunk_mem_size();
+    }
+
+    static size_t chunk_mem_size() BK_NOEXCEPT {
+        return chunk_size * chunk_size * sizeof(tile_data) + sizeof(entry_);
+    }
+
+    //! @returns The key of the chunk containing @c p.
+    static chunk_key key_of(point p) BK_NOEXCEPT {
+        auto const n = static_cast<int>(chunk_size);
+        //round toward negative infinity.
+        auto const div = [n](int const v) { return (v >= 0) ? v / n : -((-v + n - 1) / n); };
+        return {div(p.x), div(p.y)};
+    }
+private:
+    struct entry_ {
+        entry_(chunk_key key)
+          : key{key}, data{chunk_size, chunk_size}
+        {
+        }
+
+        entry_(entry_&& other)
+          : key{other.key}, data{std::move(other.data)}
+        {
+        }
+
+        chunk_key key;
+        chunk     data;
+    };
+
+    using list_t = std::list<entry_>;
+
+    static uint64_t hash_key_(chunk_key const key) BK_NOEXCEPT {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(key.x)) << 32)
+             | static_cast<uint64_t>(static_cast<uint32_t>(key.y));
+    }
+
+    void evict_();
+
+    size_t    budget_;
+    size_t    max_chunks_;
+    generator generator_;
+    evictor   evictor_;
+
+    list_t lru_; //most recently used at the front.
+    std::unordered_map<uint64_t, list_t::iterator> index_;
+};
+
+} //namespace tez
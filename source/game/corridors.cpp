@@ -0,0 +1,425 @@
+#include "pch.hpp"
+
+#include "corridors.hpp"
+
+using corridors = tez::generator::corridors;
+using point     = corridors::point;
+using link_t    = corridors::link; //link() is taken by POSIX.
+
+namespace {
+//==============================================================================
+//! Exact enough for the integral room centers used here.
+//==============================================================================
+struct vertex { double x, y; };
+
+//! > 0 if a, b, c are counter clockwise.
+double orient(vertex const a, vertex const b, vertex const c) BK_NOEXCEPT {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+//! > 0 if d is inside the circumcircle of the counter clockwise a, b, c.
+double in_circle(vertex const a, vertex const b, vertex const c, vertex const d) BK_NOEXCEPT {
+    auto const ax = a.x - d.x, ay = a.y - d.y;
+    auto const bx = b.x - d.x, by = b.y - d.y;
+    auto const cx = c.x - d.x, cy = c.y - d.y;
+
+    auto const a2 = ax * ax + ay * ay;
+    auto const b2 = bx * bx + by * by;
+    auto const c2 = cx * cx + cy * cy;
+
+    return ax * (by * c2 - b2 * cy)
+         - ay * (bx * c2 - b2 * cx)
+         + a2 * (bx * cy - by * cx);
+}
+//==============================================================================
+//! Counter clockwise triangle; n[i] is the neighbour opposite v[i] or -1.
+//==============================================================================
+struct triangle {
+    std::array<uint32_t, 3> v;
+    std::array<int32_t,  3> n;
+};
+
+//==============================================================================
+//! Incremental (Bowyer-Watson) Delaunay triangulation. Points are located by
+//! walking from the last triangle created and inserted in a spatially
+//! coherent order, so walks are short; the cavity of each insertion is found
+//! through the triangle adjacency.
+//==============================================================================
+class delaunay {
+public:
+    explicit delaunay(std::vector<point> const& points)
+      : stamp_{0}
+      , last_{0}
+    {
+        auto const n = points.size();
+
+        auto min_x = std::numeric_limits<double>::max(), max_x = -min_x;
+        auto min_y = min_x,                                max_y = -min_x;
+
+        verts_.reserve(n + 3);
+        for (auto const& p : points) {
+            verts_.push_back(vertex {p.x, p.y});
+            min_x = std::min<double>(min_x, p.x); max_x = std::max<double>(max_x, p.x);
+            min_y = std::min<double>(min_y, p.y); max_y = std::max<double>(max_y, p.y);
+        }
+
+        //a triangle containing every point.
+        auto const d  = std::max(1.0, std::max(max_x - min_x, max_y - min_y));
+        auto const cx = (min_x + max_x) / 2.0;
+        auto const cy = (min_y + max_y) / 2.0;
+
+        verts_.push_back(vertex {cx - 20.0 * d, cy - d});
+        verts_.push_back(vertex {cx + 20.0 * d, cy - d});
+        verts_.push_back(vertex {cx,            cy + 20.0 * d});
+
+        auto const s = static_cast<uint32_t>(n);
+        tris_.reserve(2 * n + 1);
+        tris_.push_back(triangle {{{s, s + 1, s + 2}}, {{-1, -1, -1}}});
+        marks_.push_back(0);
+
+        for (auto const i : insertion_order_(min_x, min_y, d)) {
+            insert_(i);
+        }
+    }
+
+    //! The edges between input points; the super triangle is excluded.
+    std::vector<link_t> edges() const {
+        auto const n = verts_.size() - 3;
+
+        std::vector<link_t> result;
+        result.reserve(tris_.size() * 3 / 2);
+
+        for (size_t t = 0; t < tris_.size(); ++t) {
+            auto const& tri = tris_[t];
+
+            for (size_t i = 0; i < 3; ++i) {
+                //each shared edge once; from the lower numbered triangle.
+                auto const nb = tri.n[i];
+                if (nb >= 0 && static_cast<size_t>(nb) < t) continue;
+
+                size_t const a = tri.v[(i + 1) % 3];
+                size_t const b = tri.v[(i + 2) % 3];
+                if (a >= n || b >= n) continue;
+
+                result.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        }
+
+        std::sort(std::begin(result), std::end(result));
+        return result;
+    }
+private:
+    //! Serpentine order over vertical strips of about sqrt(n) points.
+    std::vector<uint32_t> insertion_order_(double const min_x, double const min_y, double const d) const {
+        auto const n = verts_.size() - 3;
+        auto const strips = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(n) / 2.0)));
+
+        auto const strip_of = [&](uint32_t const i) {
+            auto const s = static_cast<size_t>((verts_[i].x - min_x) / d * strips);
+            return std::min(s, strips - 1);
+        };
+
+        std::vector<uint32_t> order(n);
+        for (size_t i = 0; i < n; ++i) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+
+        std::sort(std::begin(order), std::end(order), [&](uint32_t const a, uint32_t const b) {
+            auto const sa = strip_of(a);
+            auto const sb = strip_of(b);
+            if (sa != sb) return sa < sb;
+
+            auto const ya = verts_[a].y - min_y;
+            auto const yb = verts_[b].y - min_y;
+            if (ya != yb) return (sa % 2) ? (ya > yb) : (ya < yb);
+
+            return a < b;
+        });
+
+        return order;
+    }
+
+    bool in_circle_(int32_t const t, vertex const p) const {
+        auto const& v = tris_[t].v;
+        return in_circle(verts_[v[0]], verts_[v[1]], verts_[v[2]], p) > 0.0;
+    }
+
+    //! Walk toward p; the starting edge rotates to avoid cycles.
+    int32_t locate_(vertex const p) const {
+        auto t = last_;
+
+        for (size_t step = 0; ; ++step) {
+            auto const& tri = tris_[t];
+            auto next = int32_t {-1};
+
+            for (size_t k = 0; k < 3; ++k) {
+                auto const i = (k + step) % 3;
+                auto const a = verts_[tri.v[(i + 1) % 3]];
+                auto const b = verts_[tri.v[(i + 2) % 3]];
+
+                if (orient(a, b, p) < 0.0 && tri.n[i] >= 0) {
+                    next = tri.n[i];
+                    break;
+                }
+            }
+
+            if (next < 0) return t;
+            t = next;
+        }
+    }
+
+    void insert_(uint32_t const pi) {
+        auto const p = verts_[pi];
+
+        //the triangles whose circumcircle contains p.
+        ++stamp_;
+        bad_.clear();
+        stack_.clear();
+
+        auto const first = locate_(p);
+        marks_[first] = stamp_;
+        stack_.push_back(first);
+
+        while (!stack_.empty()) {
+            auto const t = stack_.back();
+            stack_.pop_back();
+            bad_.push_back(t);
+
+            for (auto const nb : tris_[t].n) {
+                if (nb < 0 || marks_[nb] == stamp_ || !in_circle_(nb, p)) continue;
+                marks_[nb] = stamp_;
+                stack_.push_back(nb);
+            }
+        }
+
+        //the boundary of the cavity; counter clockwise edges (a, b).
+        boundary_.clear();
+        for (auto const t : bad_) {
+            auto const& tri = tris_[t];
+            for (size_t i = 0; i < 3; ++i) {
+                auto const nb = tri.n[i];
+                if (nb >= 0 && marks_[nb] == stamp_) continue;
+                boundary_.push_back(edge {tri.v[(i + 1) % 3], tri.v[(i + 2) % 3], nb, 0});
+            }
+        }
+
+        //one new triangle (a, b, p) per edge; reuse the slots of the cavity.
+        for (size_t k = 0; k < boundary_.size(); ++k) {
+            if (k < bad_.size()) {
+                boundary_[k].id = bad_[k];
+            } else {
+                boundary_[k].id = static_cast<int32_t>(tris_.size());
+                tris_.push_back(triangle {});
+                marks_.push_back(0);
+            }
+        }
+
+        for (auto const& e : boundary_) {
+            auto& tri = tris_[e.id];
+            tri.v = {{e.a, e.b, pi}};
+            tri.n = {{-1, -1, e.outer}};
+
+            //the outer triangle has the same edge as (b, a).
+            if (e.outer >= 0) {
+                auto& outer = tris_[e.outer];
+                for (size_t j = 0; j < 3; ++j) {
+                    if (outer.v[(j + 1) % 3] == e.b && outer.v[(j + 2) % 3] == e.a) {
+                        outer.n[j] = e.id;
+                    }
+                }
+            }
+        }
+
+        //link the new triangles to each other across the edges through p.
+        for (auto const& e : boundary_) {
+            auto& tri = tris_[e.id];
+            for (auto const& o : boundary_) {
+                if (o.a == e.b) tri.n[0] = o.id; //edge (b, p)
+                if (o.b == e.a) tri.n[1] = o.id; //edge (p, a)
+            }
+        }
+
+        last_ = boundary_.front().id;
+    }
+
+    struct edge {
+        uint32_t a, b;
+        int32_t  outer; //!< triangle beyond the edge or -1.
+        int32_t  id;    //!< the new triangle.
+    };
+
+    std::vector<vertex>   verts_;
+    std::vector<triangle> tris_;
+    std::vector<uint32_t> marks_;
+    uint32_t              stamp_;
+    int32_t               last_;
+
+    std::vector<int32_t> bad_;
+    std::vector<int32_t> stack_;
+    std::vector<edge>    boundary_;
+};
+//==============================================================================
+//! Disjoint sets with path halving.
+//==============================================================================
+class union_find {
+public:
+    explicit union_find(size_t const n) : parent_(n) {
+        for (size_t i = 0; i < n; ++i) parent_[i] = i;
+    }
+
+    size_t find(size_t i) {
+        while (parent_[i] != i) {
+            parent_[i] = parent_[parent_[i]];
+            i = parent_[i];
+        }
+        return i;
+    }
+
+    //! @returns false if a and b were already joined.
+    bool join(size_t const a, size_t const b) {
+        auto const ra = find(a);
+        auto const rb = find(b);
+        if (ra == rb) return false;
+
+        parent_[ra] = rb;
+        return true;
+    }
+private:
+    std::vector<size_t> parent_;
+};
+//==============================================================================
+//! @c edges sorted by length; ties by index so the order is deterministic.
+//==============================================================================
+std::vector<link_t> by_length(std::vector<point> const& points, std::vector<link_t> edges) {
+    auto const length2 = [&](link_t const& e) {
+        auto const dx = static_cast<double>(points[e.first].x) - points[e.second].x;
+        auto const dy = static_cast<double>(points[e.first].y) - points[e.second].y;
+        return dx * dx + dy * dy;
+    };
+
+    std::sort(std::begin(edges), std::end(edges), [&](link_t const& a, link_t const& b) {
+        auto const la = length2(a);
+        auto const lb = length2(b);
+        return (la != lb) ? (la < lb) : (a < b);
+    });
+
+    return edges;
+}
+} //namespace
+
+//==============================================================================
+std::vector<link_t> tez::generator::delaunay_edges(std::vector<point> const& points) {
+    if (points.size() < 2) return {};
+    if (points.size() == 2) return {link_t {0, 1}};
+
+    return delaunay {points}.edges();
+}
+
+std::vector<link_t> tez::generator::minimum_spanning_tree(
+    std::vector<point> const& points
+  , std::vector<link_t> const& edges
+) {
+    union_find sets {points.size()};
+
+    std::vector<link_t> result;
+    for (auto const& e : by_length(points, edges)) {
+        if (sets.join(e.first, e.second)) result.push_back(e);
+    }
+
+    return result;
+}
+
+//==============================================================================
+std::vector<link_t> corridors::connect(std::vector<rect> const& rects, random& rand) const {
+    std::vector<point> centers;
+    centers.reserve(rects.size());
+    for (auto const& r : rects) {
+        centers.push_back(bklib::bounding_circle(r).p);
+    }
+
+    union_find sets {centers.size()};
+    std::bernoulli_distribution keep_extra {extra_};
+
+    //the spanning tree plus some of the other edges.
+    std::vector<link_t> result;
+    for (auto const& e : by_length(centers, delaunay_edges(centers))) {
+        if (sets.join(e.first, e.second) || keep_extra(rand)) {
+            result.push_back(e);
+        }
+    }
+
+    //degenerate input (e.g. coincident centers) can leave several parts.
+    for (size_t i = 1; i < centers.size(); ++i) {
+        if (sets.join(i - 1, i)) result.emplace_back(i - 1, i);
+    }
+
+    return result;
+}
+
+void corridors::carve(
+    grid2d<tile_data>&       dest
+  , std::vector<rect> const& rects
+  , std::vector<link_t> const& links
+  , random&                  rand
+) const {
+    using index = grid2d<tile_data>::index;
+
+    //reads go through get() so that only tiles actually changed are dirty.
+    auto const is_wall = [&](int const x, int const y) {
+        auto const i = index {static_cast<size_t>(x), static_cast<size_t>(y)};
+        return dest.is_valid(i) && dest.get(i).type == tile_type::wall;
+    };
+
+    //open the tile at (x, y) reached moving horizontally or vertically.
+    auto const dig = [&](int const x, int const y, bool const horizontal) {
+        auto const here = index {static_cast<size_t>(x), static_cast<size_t>(y)};
+        auto const type = dest.get(here).type;
+
+        if (type == tile_type::wall) {
+            //crossing a wall rather than running along it.
+            auto const crossing = horizontal
+              ? (is_wall(x, y - 1) && is_wall(x, y + 1))
+              : (is_wall(x - 1, y) && is_wall(x + 1, y));
+            dest[here].type = crossing ? tile_type::door : tile_type::floor;
+        } else if (type == tile_type::empty) {
+            dest[here].type = tile_type::floor;
+        } else {
+            return;
+        }
+
+        //an opened wall can border empty space too; enclose every open tile.
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                auto const i = index {static_cast<size_t>(x + dx), static_cast<size_t>(y + dy)};
+                if (dest.is_valid(i) && dest.get(i).type == tile_type::empty) {
+                    dest[i].type = tile_type::wall;
+                }
+            }
+        }
+    };
+
+    auto const run_x = [&](int const y, int const x0, int const x1) {
+        auto const d = (x1 >= x0) ? 1 : -1;
+        for (auto x = x0; x != x1 + d; x += d) dig(x, y, true);
+    };
+
+    auto const run_y = [&](int const x, int const y0, int const y1) {
+        auto const d = (y1 >= y0) ? 1 : -1;
+        for (auto y = y0; y != y1 + d; y += d) dig(x, y, false);
+    };
+
+    std::bernoulli_distribution horizontal_first {0.5};
+
+    for (auto const& l : links) {
+        auto const a = rects[l.first].center<int>();
+        auto const b = rects[l.second].center<int>();
+
+        if (horizontal_first(rand)) {
+            run_x(a.y, a.x, b.x);
+            run_y(b.x, a.y, b.y);
+        } else {
+            run_y(a.x, a.y, b.y);
+            run_x(b.y, a.x, b.x);
+        }
+    }
+}
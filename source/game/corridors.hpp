@@ -0,0 +1,66 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "assert.hpp"
+#include "math.hpp"
+
+#include "tile_data.hpp"
+#include "grid2d.hpp"
+#include "room.hpp"
+
+namespace tez {
+namespace generator {
+
+//==============================================================================
+//! Connects the rooms of a layout with corridors.
+//!
+//! The room centers are triangulated (Delaunay); the minimum spanning tree of
+//! the triangulation connects every room, and a fraction of the remaining
+//! edges adds loops. Each link is carved as an L-shaped corridor. Expected
+//! O(n log n) in the number of rooms.
+//==============================================================================
+struct corridors {
+    using rect  = bklib::axis_aligned_rect<int>;
+    using point = bklib::point2d<float>;
+    using link  = std::pair<size_t, size_t>;
+
+    //! @param extra The fraction of non tree edges kept as extra links.
+    explicit corridors(float extra = 0.15f)
+      : extra_{extra} {}
+
+    //! @returns The links (i, j), i < j, between the rooms @c rects.
+    std::vector<link> connect(std::vector<rect> const& rects, random& rand) const;
+
+    //! Carve a corridor for each link into @c dest. Empty tiles become floor
+    //! with walls around them; room walls crossed become doors.
+    //! @pre The rects are within dest (e.g. after layout_random::normalize()).
+    void carve(
+        grid2d<tile_data>&       dest
+      , std::vector<rect> const& rects
+      , std::vector<link> const& links
+      , random&                  rand
+    ) const;
+
+    float extra_;
+};
+
+//==============================================================================
+//! @returns The edges (i, j), i < j, of the Delaunay triangulation of
+//! @c points; expected O(n log n).
+//==============================================================================
+std::vector<corridors::link> delaunay_edges(std::vector<corridors::point> const& points);
+
+//==============================================================================
+//! @returns The edges of the minimum spanning tree over @c edges weighted by
+//! distance; sorted by weight.
+//==============================================================================
+std::vector<corridors::link> minimum_spanning_tree(
+    std::vector<corridors::point> const& points
+  , std::vector<corridors::link>  const& edges
+);
+
+} //namespace generator
+} //namespace tez
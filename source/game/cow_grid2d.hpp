@@ -0,0 +1,202 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "config.hpp"
+#include "assert.hpp"
+
+#include "grid2d.hpp"
+
+namespace tez {
+
+//==============================================================================
+//! A 2D grid of values stored as square chunks which are shared between
+//! snapshots and copied on first write.
+//!
+//! snapshot() is O(number of chunks) and copies no values; afterwards the
+//! first write to a chunk by either grid copies that chunk only. A snapshot
+//! may be read from another thread while the original continues to be
+//! written: chunks reachable from a snapshot are never modified.
+//!
+//! Whether a chunk may be written in place is decided by a per chunk stamp,
+//! not by use_count(): a chunk is written in place only if this grid copied
+//! it since its last snapshot(). use_count() is a relaxed load, so seeing 1
+//! would not order the write after another thread's last read.
+//!
+//! @tparam T The value type.
+//! @tparam N The chunk dimension; must be a power of two.
+//==============================================================================
+template <typename T, size_t N = 32>
+class cow_grid2d {
+public:
+    using index_t = size_t;
+    using index   = index2d<index_t>;
+    using layout  = layout_blocked<N>;
+
+    using reference       = T&;
+    using const_reference = T const&;
+
+    static size_t const chunk_size = N;
+
+    //No implicit copies; use snapshot().
+    cow_grid2d(cow_grid2d const&) = delete;
+    cow_grid2d& operator=(cow_grid2d const&) = delete;
+
+    cow_grid2d(cow_grid2d&& other)
+      : width_(other.width_)
+      , height_(other.height_)
+      , layout_(other.layout_)
+      , chunks_(std::move(other.chunks_))
+      , stamps_(std::move(other.stamps_))
+      , generation_(other.generation_)
+    {
+    }
+
+    cow_grid2d& operator=(cow_grid2d&& rhs) {
+        rhs.swap(*this);
+        return *this;
+    }
+
+    void swap(cow_grid2d& other) {
+        using std::swap;
+        swap(width_,  other.width_);
+        swap(height_, other.height_);
+        swap(layout_, other.layout_);
+        swap(chunks_, other.chunks_);
+        swap(stamps_, other.stamps_);
+        swap(generation_, other.generation_);
+    }
+
+    //! Every chunk initially shares the same storage.
+    cow_grid2d(index_t const w, index_t const h, T const value = T {})
+      : width_{w}
+      , height_{h}
+      , layout_{w, h}
+      , chunks_(layout_.blocks_x_ * layout_.blocks_y_)
+      , stamps_(chunks_.size(), 0)
+      , generation_{1}
+    {
+        auto const shared = std::make_shared<chunk_t>(N * N, value);
+        std::fill(std::begin(chunks_), std::end(chunks_), shared);
+    }
+
+    template <typename Layout>
+    explicit cow_grid2d(grid2d<T, Layout> const& src)
+      : cow_grid2d(src.width(), src.height())
+    {
+        for (auto& c : chunks_) {
+            c = std::make_shared<chunk_t>(N * N);
+        }
+
+        std::fill(std::begin(stamps_), std::end(stamps_), generation_);
+
+        for (auto const& i : src) {
+            chunk_(i.i)[local_(i.i)] = i.value;
+        }
+    }
+
+    //! @returns A grid sharing every chunk with this one.
+    //! Non-const: it changes which chunks this grid may write in place, so it
+    //! must not race with other uses of this grid.
+    cow_grid2d snapshot() {
+        //every chunk is shared from now on; the next write to each copies it.
+        if (++generation_ == 0) ++generation_;
+        return cow_grid2d {width_, height_, layout_, chunks_};
+    }
+
+    //! @returns A deep copy as a plain grid.
+    grid2d<T> to_grid() const {
+        auto result = grid2d<T>(width_, height_);
+
+        for (auto const row : result.rows()) {
+            for (size_t x = 0; x < row.values.size(); ++x) {
+                row.values[x] = (*this)[{x, row.y}];
+            }
+        }
+
+        return result;
+    }
+
+    size_t width()  const BK_NOEXCEPT { return width_; }
+    size_t height() const BK_NOEXCEPT { return height_; }
+    size_t size()   const BK_NOEXCEPT { return width() * height(); }
+
+    size_t chunk_count() const BK_NOEXCEPT { return chunks_.size(); }
+
+    //! @returns The number of chunks shared with any other grid.
+    size_t shared_chunk_count() const BK_NOEXCEPT {
+        return static_cast<size_t>(std::count_if(
+            std::begin(chunks_), std::end(chunks_)
+          , [](std::shared_ptr<chunk_t> const& c) { return c.use_count() != 1; }
+        ));
+    }
+
+    bool is_valid(index i) const BK_NOEXCEPT {
+        return (i.x < width_) && (i.y < height_);
+    }
+
+    const_reference operator[](index i) const {
+        BK_ASSERT(is_valid(i));
+        return (*chunks_[chunk_index_(i)])[local_(i)];
+    }
+
+    //! Mutable access; copies the chunk containing @c i if it is shared.
+    reference operator[](index i) {
+        BK_ASSERT(is_valid(i));
+        return chunk_(i)[local_(i)];
+    }
+
+    //! Explicit read only access for a mutable grid.
+    const_reference get(index i) const {
+        return (*this)[i];
+    }
+private:
+    using chunk_t = std::vector<T>;
+
+    cow_grid2d(
+        index_t const w
+      , index_t const h
+      , layout const  l
+      , std::vector<std::shared_ptr<chunk_t>> const& chunks
+    )
+      : width_{w}
+      , height_{h}
+      , layout_{l}
+      , chunks_(chunks)
+      , stamps_(chunks.size(), 0)
+      , generation_{1}
+    {
+    }
+
+    size_t chunk_index_(index i) const BK_NOEXCEPT {
+        return (i.y / N) * layout_.blocks_x_ + (i.x / N);
+    }
+
+    static size_t local_(index i) BK_NOEXCEPT {
+        return (i.y % N) * N + (i.x % N);
+    }
+
+    //! @returns The chunk containing @c i for writing; unshared first.
+    chunk_t& chunk_(index i) {
+        auto const n = chunk_index_(i);
+        auto& c = chunks_[n];
+
+        if (stamps_[n] != generation_) {
+            c = std::make_shared<chunk_t>(*c);
+            stamps_[n] = generation_;
+        }
+
+        return *c;
+    }
+
+    index_t width_;
+    index_t height_;
+    layout  layout_;
+
+    std::vector<std::shared_ptr<chunk_t>> chunks_;
+    std::vector<uint32_t> stamps_;     //!< the generation each chunk was copied in.
+    uint32_t              generation_; //!< bumped by snapshot(); never 0.
+};
+
+} //namespace tez
@@ -1,12 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
 #include <vector>
 
-#include <boost/iterator/iterator_adaptor.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/range/iterator_range.hpp>
 
 #include "config.hpp"
 #include "assert.hpp"
 #include "math.hpp"
+#include "span.hpp"
 
 namespace tez {
 
@@ -19,8 +24,8 @@ struct index2d {
         BK_ASSERT(y + dy >= 0);
         BK_ASSERT(x + dx >= 0);
 
-        auto const yy = static_cast<size_t(y + dy);
-        auto const xx = static_cast<size_t(x + dx);
+        auto const yy = static_cast<size_t>(y + dy);
+        auto const xx = static_cast<size_t>(x + dx);
 
         return yy * stride + xx;
     }
@@ -35,6 +40,71 @@ template <typename T> index2d<T> west_of(index2d<T> i)  { return {i.x - 1, i.y +
 //==============================================================================
 
 
+//==============================================================================
+//! Storage layouts for grid2d.
+//!
+//! A layout maps a logical (x, y) position to an offset in the underlying
+//! storage. Layouts are small value types; iterators keep a copy.
+//==============================================================================
+//! Conventional row-major layout; rows are contiguous.
+//==============================================================================
+struct layout_row_major {
+    static bool const has_contiguous_rows = true;
+
+    layout_row_major() BK_NOEXCEPT : width_{0}, height_{0} {}
+
+    layout_row_major(size_t const w, size_t const h) BK_NOEXCEPT
+      : width_{w}
+      , height_{h}
+    {
+    }
+
+    //! Number of elements of storage required.
+    size_t storage_size() const BK_NOEXCEPT { return width_ * height_; }
+
+    size_t to_index(size_t const x, size_t const y) const BK_NOEXCEPT {
+        return y * width_ + x;
+    }
+
+    size_t width_;
+    size_t height_;
+};
+//==============================================================================
+//! Cache-blocked layout; the grid is stored as a row-major sequence of
+//! N x N blocks, each of which is itself row-major. Local neighbourhoods stay
+//! within one or two cache lines regardless of the grid width.
+//!
+//! @tparam N The block dimension; must be a power of two.
+//==============================================================================
+template <size_t N>
+struct layout_blocked {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "block size must be a power of 2.");
+
+    static bool const   has_contiguous_rows = false;
+    static size_t const block_size          = N;
+
+    layout_blocked() BK_NOEXCEPT : blocks_x_{0}, blocks_y_{0} {}
+
+    layout_blocked(size_t const w, size_t const h) BK_NOEXCEPT
+      : blocks_x_{(w + N - 1) / N}
+      , blocks_y_{(h + N - 1) / N}
+    {
+    }
+
+    //! Number of elements of storage required; rounded up to whole blocks.
+    size_t storage_size() const BK_NOEXCEPT {
+        return blocks_x_ * blocks_y_ * N * N;
+    }
+
+    size_t to_index(size_t const x, size_t const y) const BK_NOEXCEPT {
+        auto const block = (y / N) * blocks_x_ + (x / N);
+        return block * (N * N) + (y % N) * N + (x % N);
+    }
+
+    size_t blocks_x_;
+    size_t blocks_y_;
+};
+
 namespace detail {
     //==========================================================================
     template <typename T>
@@ -65,189 +135,518 @@ namespace detail {
 
     template <typename T>
     bool operator==(T const& lhs, grid_iterator_value<T> const& rhs) { return lhs == rhs.value; }
-
-    //==========================================================================
-    template <typename T>
-    struct grid_iterator_traits {
-        using base      = typename std::vector<T>::iterator;
-        using value     = grid_iterator_value<T>;
-        using traversal = boost::random_access_traversal_tag;
-        using reference = value;
-    };
-
-    template <typename T>
-    struct grid_iterator_traits<T const> {
-        using base      = typename std::vector<T>::const_iterator;
-        using value     = grid_iterator_value<T const>;
-        using traversal = boost::random_access_traversal_tag;
-        using reference = value;
-    };
     //==========================================================================
 } //namespace detail
 
 //==============================================================================
-template <typename T>
-class grid_iterator : public boost::iterator_adaptor<
-    grid_iterator<T>                                    // Derived
-  , typename detail::grid_iterator_traits<T>::base      // Base
-  , typename detail::grid_iterator_traits<T>::value     // Value
-  , typename detail::grid_iterator_traits<T>::traversal // CategoryOrTraversal
-  , typename detail::grid_iterator_traits<T>::reference // Reference
+//! Iterates over a grid in logical row-major order irrespective of the
+//! storage layout. The position is tracked as (x, y) and stepped
+//! incrementally; only advance() by more than one element needs a division.
+//==============================================================================
+template <typename T, typename Layout = layout_row_major>
+class grid_iterator : public boost::iterator_facade<
+    grid_iterator<T, Layout>              // Derived
+  , detail::grid_iterator_value<T>        // Value
+  , boost::random_access_traversal_tag    // CategoryOrTraversal
+  , detail::grid_iterator_value<T>        // Reference
 > {
 public:
+    using reference       = detail::grid_iterator_value<T>;
+    using difference_type = std::ptrdiff_t;
+
     grid_iterator() BK_NOEXCEPT
-      : grid_iterator::iterator_adaptor_ {}
+      : data_{nullptr}
+      , layout_{}
       , width_{0}
       , height_{0}
-      , pos_{}
+      , x_{0}
+      , y_{0}
     {
     }
 
-    grid_iterator(base_type it, size_t w, size_t h, size_t pos = 0)
-      : grid_iterator::iterator_adaptor_ {it}
+    grid_iterator(T* data, Layout layout, size_t w, size_t h, size_t pos = 0)
+      : data_{data}
+      , layout_{layout}
       , width_{w}
       , height_{h}
-      , pos_{pos}
+      , x_{0}
+      , y_{0}
     {
+        if (pos) advance(static_cast<difference_type>(pos));
     }
 
     template <typename U>
     grid_iterator(
-        grid_iterator<U> const& other
+        grid_iterator<U, Layout> const& other
       , typename std::enable_if<std::is_convertible<U*,T*>::value>::type* = nullptr
     )
-      : grid_iterator(other.base(), width_, height_, pos_)
+      : data_{other.data_}
+      , layout_{other.layout_}
+      , width_{other.width_}
+      , height_{other.height_}
+      , x_{other.x_}
+      , y_{other.y_}
     {
     }
  private:
     friend class boost::iterator_core_access;
+    template <typename, typename> friend class grid_iterator;
 
-    typename iterator_adaptor::reference dereference() const {
-        BK_ASSERT(width_ > 0 && height_ > 0);
+    size_t pos_() const BK_NOEXCEPT { return y_ * width_ + x_; }
 
-        auto const d = std::div(
-            static_cast<intmax_t>(pos_), static_cast<intmax_t>(width_)
-        );
+    reference dereference() const {
+        BK_ASSERT(x_ < width_ && y_ < height_);
+        return reference(data_[layout_.to_index(x_, y_)], {x_, y_});
+    }
+
+    template <typename U>
+    bool equal(grid_iterator<U, Layout> const& other) const BK_NOEXCEPT {
+        return x_ == other.x_ && y_ == other.y_;
+    }
 
-        return value_type(
-            *base()
-          , {static_cast<size_t>(d.rem), static_cast<size_t>(d.quot)}
-        );
+    template <typename U>
+    difference_type distance_to(grid_iterator<U, Layout> const& other) const BK_NOEXCEPT {
+        return static_cast<difference_type>(other.pos_())
+             - static_cast<difference_type>(pos_());
     }
 
-    void advance(typename iterator_adaptor::difference_type n) {
-        BK_ASSERT(pos_ + n <= width_ * height_);
+    void advance(difference_type n) {
+        auto const pos = static_cast<difference_type>(pos_()) + n;
+        BK_ASSERT(pos >= 0 && static_cast<size_t>(pos) <= width_ * height_);
+
+        if (width_ == 0) return;
 
-        base_reference() = base() + n;
-        pos_ += n;
+        x_ = static_cast<size_t>(pos) % width_;
+        y_ = static_cast<size_t>(pos) / width_;
     }
 
     void decrement() {
-        advance(-1);
+        BK_ASSERT(x_ > 0 || y_ > 0);
+        if (x_-- == 0) { x_ = width_ - 1; --y_; }
     }
 
     void increment() {
-        advance(1);
+        BK_ASSERT(y_ < height_);
+        if (++x_ == width_) { x_ = 0; ++y_; }
     }
 
-    size_t pos_;
+    T*     data_;
+    Layout layout_;
     size_t width_;
     size_t height_;
+    size_t x_;
+    size_t y_;
 };
 //==============================================================================
+template <typename T, typename Layout = layout_row_major>
+using const_grid_iterator = grid_iterator<T const, Layout>;
+//==============================================================================
+//! Forward iterator over a grid_view; steps x and y incrementally.
+//==============================================================================
 template <typename T>
-using const_grid_iterator = grid_iterator<T const>;
+class grid_view_iterator : public boost::iterator_facade<
+    grid_view_iterator<T>                 // Derived
+  , detail::grid_iterator_value<T>        // Value
+  , boost::forward_traversal_tag          // CategoryOrTraversal
+  , detail::grid_iterator_value<T>        // Reference
+> {
+public:
+    using reference = detail::grid_iterator_value<T>;
+
+    grid_view_iterator() BK_NOEXCEPT
+      : row_{nullptr}, width_{0}, height_{0}, stride_{0}, x_{0}, y_{0}
+    {
+    }
+
+    grid_view_iterator(T* row, size_t w, size_t h, size_t stride, size_t y)
+      : row_{row}, width_{w}, height_{h}, stride_{stride}, x_{0}, y_{y}
+    {
+    }
+
+    template <typename U>
+    grid_view_iterator(
+        grid_view_iterator<U> const& other
+      , typename std::enable_if<std::is_convertible<U*,T*>::value>::type* = nullptr
+    )
+      : row_{other.row_}, width_{other.width_}, height_{other.height_}
+      , stride_{other.stride_}, x_{other.x_}, y_{other.y_}
+    {
+    }
+private:
+    friend class boost::iterator_core_access;
+    template <typename> friend class grid_view_iterator;
+
+    reference dereference() const {
+        BK_ASSERT(x_ < width_ && y_ < height_);
+        return reference(row_[x_], {x_, y_});
+    }
+
+    template <typename U>
+    bool equal(grid_view_iterator<U> const& other) const BK_NOEXCEPT {
+        return x_ == other.x_ && y_ == other.y_;
+    }
+
+    void increment() {
+        if (++x_ != width_) return;
+
+        x_ = 0;
+        if (++y_ < height_) row_ += stride_;
+    }
+
+    T*     row_;
+    size_t width_;
+    size_t height_;
+    size_t stride_;
+    size_t x_;
+    size_t y_;
+};
+//==============================================================================
+//! A single row of a grid; @c values is contiguous.
+//==============================================================================
+template <typename T>
+struct grid_row {
+    size_t         y;
+    bklib::span<T> values;
+};
 //==============================================================================
-//
-//template <typename T, typename IndexType>
-//class grid_sub_itererator
-//  : public boost::iterator_adaptor<
-//        grid_sub_itererator<T, IndexType>                            // Derived
-//      , typename grid_itererator_traits<T, IndexType>::base      // Base
-//      , typename grid_itererator_traits<T, IndexType>::value     // Value
-//      , typename grid_itererator_traits<T, IndexType>::traversal // CategoryOrTraversal
-//      , typename grid_itererator_traits<T, IndexType>::reference // Reference
-//    >
-//{
-//public:
-//    grid_sub_itererator() BK_NOEXCEPT
-//      : grid_sub_itererator::iterator_adaptor_ {}
-//      , width_ {0}, height_ {0}, pos_ {}
-//    {
-//    }
-//
-//    grid_sub_itererator(base_type it, size_t offset, size_t stride, IndexType w, IndexType h)
-//      : grid_sub_itererator::iterator_adaptor_ {it + offset}
-//        , width_ {w}, height_ {h}, pos_ {0}, offset_ {offset}, stride_ {stride}
-//    {
-//    }
-//
-//    template <typename U>
-//    grid_sub_itererator(
-//        grid_sub_itererator<U, IndexType> const& other
-//      , typename std::enable_if<std::is_convertible<U*,T*>::value>::type* = nullptr
-//    )
-//        : grid_sub_itererator::iterator_adaptor_(other.base())
-//    {
-//    }
-// private:
-//    friend class boost::iterator_core_access;
-//
-//    typename iterator_adaptor::reference dereference() const {
-//        auto const x = (pos_ % width_) + (stride_ - width_);
-//        auto const y = (pos_ + offset_) / stride_;
-//
-//        return grid_itererator_value<T, IndexType>(
-//            *base(), {static_cast<IndexType>(x), static_cast<IndexType>(y) }
-//        );
-//    }
-//
-//    void advance(typename iterator_adaptor::difference_type n) {
-//        auto dx = (pos_ + n) % width_;
-//        auto dy = ((pos_ + n) / width_) - (pos_ / width_);
-//
-//        BK_ASSERT(pos_ + n >= 0);
-//        BK_ASSERT(pos_ + n <= width_ + height_);
-//
-//        if (pos_ + n == width_ + height_) {
-//            base_reference() = base() + n;
-//        } else {
-//            base_reference() = base() + n + dy*(stride_ - width_ + 1);
-//        }
-//
-//        pos_ += n;
-//    }
-//
-//    void decrement() {
-//        advance(-1);
-//    }
-//
-//    void increment() {
-//        advance(+1);
-//    }
-//
-//    size_t pos_;
-//    size_t offset_;
-//    size_t stride_;
-//
-//    IndexType width_;
-//    IndexType height_;
-//};
+//! Iterates over the rows of row-major storage.
 //==============================================================================
 template <typename T>
+class grid_row_iterator : public boost::iterator_facade<
+    grid_row_iterator<T>                  // Derived
+  , grid_row<T>                           // Value
+  , boost::random_access_traversal_tag    // CategoryOrTraversal
+  , grid_row<T>                           // Reference
+> {
+public:
+    using difference_type = std::ptrdiff_t;
+
+    grid_row_iterator() BK_NOEXCEPT
+      : origin_{nullptr}, width_{0}, stride_{0}, y_{0}
+    {
+    }
+
+    grid_row_iterator(T* origin, size_t w, size_t stride, size_t y) BK_NOEXCEPT
+      : origin_{origin}, width_{w}, stride_{stride}, y_{y}
+    {
+    }
+private:
+    friend class boost::iterator_core_access;
+
+    grid_row<T> dereference() const BK_NOEXCEPT {
+        return {y_, bklib::span<T> {origin_ + y_ * stride_, width_}};
+    }
+
+    bool equal(grid_row_iterator const& other) const BK_NOEXCEPT {
+        return y_ == other.y_;
+    }
+
+    difference_type distance_to(grid_row_iterator const& other) const BK_NOEXCEPT {
+        return static_cast<difference_type>(other.y_)
+             - static_cast<difference_type>(y_);
+    }
+
+    void advance(difference_type n) BK_NOEXCEPT { y_ += n; }
+    void increment() BK_NOEXCEPT { ++y_; }
+    void decrement() BK_NOEXCEPT { --y_; }
+
+    T*     origin_;
+    size_t width_;
+    size_t stride_;
+    size_t y_;
+};
+
+template <typename T>
+using grid_row_range = boost::iterator_range<grid_row_iterator<T>>;
+//==============================================================================
+//! Non-owning rectangular window onto row-major storage. Views do not copy
+//! and can be nested; each row is exposed as a contiguous span.
+//==============================================================================
+template <typename T>
+class grid_view {
+public:
+    using index_t = size_t;
+    using index   = index2d<index_t>;
+
+    using reference = T&;
+    using row_type  = bklib::span<T>;
+
+    using iterator       = grid_view_iterator<T>;
+    using const_iterator = grid_view_iterator<T>;
+
+    grid_view() BK_NOEXCEPT
+      : origin_{nullptr}, width_{0}, height_{0}, stride_{0}
+    {
+    }
+
+    //! @param origin Pointer to the top left element.
+    //! @param stride Distance in elements between the start of adjacent rows.
+    grid_view(T* origin, size_t w, size_t h, size_t stride) BK_NOEXCEPT
+      : origin_{origin}, width_{w}, height_{h}, stride_{stride}
+    {
+        BK_ASSERT(stride >= w);
+    }
+
+    //! Allow grid_view<T> -> grid_view<T const>.
+    template <typename U>
+    grid_view(
+        grid_view<U> const& other
+      , typename std::enable_if<std::is_convertible<U*,T*>::value>::type* = nullptr
+    ) BK_NOEXCEPT
+      : grid_view(other.data(), other.width(), other.height(), other.stride())
+    {
+    }
+
+    T*     data()   const BK_NOEXCEPT { return origin_; }
+    size_t width()  const BK_NOEXCEPT { return width_; }
+    size_t height() const BK_NOEXCEPT { return height_; }
+    size_t stride() const BK_NOEXCEPT { return stride_; }
+    size_t size()   const BK_NOEXCEPT { return width_ * height_; }
+    bool   empty()  const BK_NOEXCEPT { return size() == 0; }
+
+    bool is_valid(index i) const BK_NOEXCEPT {
+        return (i.x < width_) && (i.y < height_);
+    }
+
+    reference operator[](index i) const BK_NOEXCEPT {
+        BK_ASSERT(is_valid(i));
+        return origin_[i.y * stride_ + i.x];
+    }
+
+    //! @returns Row @c y as a contiguous span of width() elements.
+    row_type row(size_t const y) const BK_NOEXCEPT {
+        BK_ASSERT(y < height_);
+        return row_type {origin_ + y * stride_, width_};
+    }
+
+    //! @returns The nested view of size w x h whose top left is at @c i.
+    grid_view sub_view(index i, size_t const w, size_t const h) const BK_NOEXCEPT {
+        BK_ASSERT(i.x + w <= width_);
+        BK_ASSERT(i.y + h <= height_);
+        return grid_view {origin_ + i.y * stride_ + i.x, w, h, stride_};
+    }
+
+    //! @returns A range over each row as a grid_row<T>.
+    grid_row_range<T> rows() const BK_NOEXCEPT {
+        return grid_row_range<T> {
+            grid_row_iterator<T> {origin_, width_, stride_, 0}
+          , grid_row_iterator<T> {origin_, width_, stride_, height_}
+        };
+    }
+
+    iterator begin() const {
+        return empty() ? end() : iterator(origin_, width_, height_, stride_, 0);
+    }
+
+    iterator end() const {
+        return iterator(origin_, width_, height_, stride_, height_);
+    }
+private:
+    T*     origin_;
+    size_t width_;
+    size_t height_;
+    size_t stride_;
+};
+
+template <typename T>
+using const_grid_view = grid_view<T const>;
+
+//==============================================================================
+//! Bulk copies between views.
+//==============================================================================
+namespace detail {
+    template <typename T>
+    void copy_row(T const* first, size_t const n, T* out, std::true_type) BK_NOEXCEPT {
+        std::memcpy(out, first, n * sizeof(T));
+    }
+
+    template <typename T>
+    void copy_row(T const* first, size_t const n, T* out, std::false_type) {
+        std::copy(first, first + n, out);
+    }
+} //namespace detail
+
+//==============================================================================
+//! Copy every element of @c src to @c dest a row at a time; rows of trivially
+//! copyable types are copied with memcpy.
+//! @pre src and dest have the same dimensions and don't overlap.
+//==============================================================================
+template <typename T>
+void blit(const_grid_view<T> const src, grid_view<T> const dest) {
+    BK_ASSERT(src.width() == dest.width() && src.height() == dest.height());
+
+    auto const w = src.width();
+
+    using trivial = std::integral_constant<bool, std::is_trivially_copyable<T>::value>;
+    for (size_t y = 0; y < src.height(); ++y) {
+        detail::copy_row(src.row(y).data(), w, dest.row(y).data(), trivial {});
+    }
+}
+
+template <typename T>
+void blit(grid_view<T> const src, grid_view<T> const dest) {
+    blit(const_grid_view<T> {src}, dest);
+}
+//==============================================================================
+//! Copy the elements of @c src for which mask(element) is true to @c dest;
+//! used for stamping irregular shapes.
+//! @pre src and dest have the same dimensions and don't overlap.
+//==============================================================================
+template <typename T, typename Mask>
+void blit(const_grid_view<T> const src, grid_view<T> const dest, Mask mask) {
+    BK_ASSERT(src.width() == dest.width() && src.height() == dest.height());
+
+    auto const w = src.width();
+
+    for (size_t y = 0; y < src.height(); ++y) {
+        auto const in  = src.row(y).data();
+        auto const out = dest.row(y).data();
+
+        for (size_t x = 0; x < w; ++x) {
+            if (mask(in[x])) out[x] = in[x];
+        }
+    }
+}
+//==============================================================================
+//! Coarse record of which square blocks of a grid have been written to.
+//!
+//! One bit per block_size x block_size block of tiles; a default constructed
+//! map is disabled and ignores all marks.
+//==============================================================================
+class dirty_map {
+public:
+    using index = index2d<size_t>;
+
+    dirty_map() BK_NOEXCEPT
+      : block_size_{0}, blocks_x_{0}, blocks_y_{0}, width_{0}, height_{0}
+    {
+    }
+
+    dirty_map(size_t const w, size_t const h, size_t const block_size)
+      : block_size_{block_size}
+      , blocks_x_{(w + block_size - 1) / block_size}
+      , blocks_y_{(h + block_size - 1) / block_size}
+      , width_{w}
+      , height_{h}
+      , bits_((blocks_x_ * blocks_y_ + 63) / 64, 0)
+    {
+        BK_ASSERT(block_size > 0);
+    }
+
+    bool   enabled()    const BK_NOEXCEPT { return block_size_ != 0; }
+    size_t block_size() const BK_NOEXCEPT { return block_size_; }
+
+    //! Mark the block containing @c i.
+    void mark(index i) BK_NOEXCEPT {
+        if (!enabled()) return;
+        set_(i.x / block_size_, i.y / block_size_);
+    }
+
+    //! Mark every block overlapping the w x h region whose top left is @c i.
+    void mark(index i, size_t const w, size_t const h) BK_NOEXCEPT {
+        if (!enabled() || w == 0 || h == 0) return;
+
+        auto const bx0 = i.x / block_size_;
+        auto const by0 = i.y / block_size_;
+        auto const bx1 = (i.x + w - 1) / block_size_;
+        auto const by1 = (i.y + h - 1) / block_size_;
+
+        for (auto by = by0; by <= by1; ++by) {
+            for (auto bx = bx0; bx <= bx1; ++bx) {
+                set_(bx, by);
+            }
+        }
+    }
+
+    void mark_all() BK_NOEXCEPT {
+        mark({0, 0}, width_, height_);
+    }
+
+    //! @returns Whether the block containing @c i is dirty.
+    bool is_dirty(index i) const BK_NOEXCEPT {
+        if (!enabled()) return false;
+
+        auto const n = (i.y / block_size_) * blocks_x_ + (i.x / block_size_);
+        return ((bits_[n / 64] >> (n % 64)) & 1) != 0;
+    }
+
+    //! @returns The number of dirty blocks.
+    size_t count() const BK_NOEXCEPT {
+        size_t result = 0;
+        for (size_t n = 0; n < blocks_x_ * blocks_y_; ++n) {
+            result += (bits_[n / 64] >> (n % 64)) & 1;
+        }
+        return result;
+    }
+
+    //! Call f(index origin, size_t w, size_t h) for each dirty block; the
+    //! region is clipped to the grid.
+    template <typename F>
+    void for_each(F f) const {
+        for (size_t w = 0; w < bits_.size(); ++w) {
+            for (auto bits = bits_[w]; bits; bits &= bits - 1) {
+                //index of the lowest set bit.
+                size_t bit = 0;
+                while (!((bits >> bit) & 1)) ++bit;
+
+                auto const n  = w * 64 + bit;
+                auto const x  = (n % blocks_x_) * block_size_;
+                auto const y  = (n / blocks_x_) * block_size_;
+
+                f(index {x, y}
+                  , std::min(block_size_, width_ - x)
+                  , std::min(block_size_, height_ - y)
+                );
+            }
+        }
+    }
+
+    void clear() BK_NOEXCEPT {
+        std::fill(std::begin(bits_), std::end(bits_), uint64_t {0});
+    }
+private:
+    void set_(size_t const bx, size_t const by) BK_NOEXCEPT {
+        BK_ASSERT(bx < blocks_x_ && by < blocks_y_);
+        auto const n = by * blocks_x_ + bx;
+        bits_[n / 64] |= uint64_t {1} << (n % 64);
+    }
+
+    size_t block_size_;
+    size_t blocks_x_;
+    size_t blocks_y_;
+    size_t width_;
+    size_t height_;
+
+    std::vector<uint64_t> bits_;
+};
+
+//==============================================================================
+//! A 2D grid of values.
+//!
+//! @tparam T The value type.
+//! @tparam Layout The storage layout; @see layout_row_major, layout_blocked.
+//!
+//! Optionally records which blocks of the grid have been written to; see
+//! enable_dirty_tracking(). get() and set() read and write exactly one
+//! element. Every other mutable access (operator[], begin(), view(), rows()
+//! and fill()) can't tell a read from a write, so it is recorded as a write to
+//! the whole region it can reach; read through get() or a const grid to avoid
+//! marking. Writes are recorded when the access is made, so writes through a
+//! view, iterator or reference obtained before clear_dirty() are not; take it
+//! again or use mark_dirty().
+//==============================================================================
+template <typename T, typename Layout = layout_row_major>
 class grid2d {
 public:
     using index_t = size_t;
     using index   = index2d<index_t>;
+    using layout  = Layout;
 
     using reference       = T&;
     using const_reference = T const&;
 
-    using iterator       = grid_iterator<T>;
-    using const_iterator = grid_iterator<T const>;
-
-    //using sub_iterator       = grid_sub_itererator<T,       IndexType>;
-    //using const_sub_iterator = grid_sub_itererator<T const, IndexType>;
+    using iterator       = grid_iterator<T, Layout>;
+    using const_iterator = grid_iterator<T const, Layout>;
 
     grid2d(grid2d const&) = delete;
     grid2d& operator=(grid2d const&) = delete;
@@ -255,7 +654,9 @@ public:
     grid2d(grid2d&& other)
       : width_(other.width_)
       , height_(other.height_)
+      , layout_(other.layout_)
       , data_(std::move(other.data_))
+      , dirty_(std::move(other.dirty_))
     {
     }
 
@@ -268,13 +669,16 @@ public:
         using std::swap;
         swap(width_, other.width_);
         swap(height_, other.height_);
+        swap(layout_, other.layout_);
         swap(data_, other.data_);
+        swap(dirty_, other.dirty_);
     }
 
     grid2d(index_t const w, index_t const h, T const value = T {})
       : width_{w}
       , height_{h}
-      , data_(w*h, value)
+      , layout_{w, h}
+      , data_(layout_.storage_size(), value)
     {
     }
 
@@ -285,12 +689,13 @@ public:
     size_t mem_size() const BK_NOEXCEPT {
         auto const c = sizeof(grid2d);
         auto const x = sizeof(T);
-        auto const n = size();
+        auto const n = data_.size();
 
         return n*x + c;
     }
 
     reference operator[](index i) {
+        dirty_.mark(i);
         return data_[index2d_to_index_(i)];
     }
 
@@ -298,58 +703,142 @@ public:
         return data_[index2d_to_index_(i)];
     }
 
+    //! Read only access for a mutable grid; never marks.
+    const_reference get(index i) const {
+        return data_[index2d_to_index_(i)];
+    }
+
+    //! Set the element at @c i to @c value, marking its block.
+    void set(index i, T const& value) {
+        dirty_.mark(i);
+        data_[index2d_to_index_(i)] = value;
+    }
+
     bool is_valid(index i) const BK_NOEXCEPT {
         return (i.x < width_) && (i.y < height_);
     }
 
-    //sub_iterator begin(point pa, point pb) {
-    //    reorder(pa, pb);
+    //! Set every element to @c value.
+    void fill(T const& value) {
+        dirty_.mark_all();
+        std::fill(std::begin(data_), std::end(data_), value);
+    }
 
-    //    BK_ASSERT(pa.x > 0);
-    //    BK_ASSERT(pa.y > 0);
+    //! Set every element of the w x h region whose top left is @c i to @c value.
+    void fill(index i, size_t const w, size_t const h, T const& value) {
+        BK_ASSERT(i.x + w <= width_);
+        BK_ASSERT(i.y + h <= height_);
 
-    //    BK_ASSERT(pb.x < width_);
-    //    BK_ASSERT(pb.y < height_);
-    //
-    //    auto const w = pb.x - pa.x;
-    //    auto const h = pb.y - pa.y;
+        dirty_.mark(i, w, h);
 
-    //    return sub_iterator(data_.begin(), index2d_to_index_(pa), width_, w, h);
-    //}
-    //
-    //sub_iterator end(point pa, point pb) {
-    //    reorder(pa, pb);
+        for (auto y = i.y; y < i.y + h; ++y) {
+            for (auto x = i.x; x < i.x + w; ++x) {
+                data_[layout_.to_index(x, y)] = value;
+            }
+        }
+    }
+
+    iterator begin() { dirty_.mark_all(); return iterator(data_.data(), layout_, width_, height_); }
+    iterator end()   { return iterator(data_.data(), layout_, width_, height_, size()); }
 
-    //    BK_ASSERT(pa.x > 0);
-    //    BK_ASSERT(pa.y > 0);
+    const_iterator begin() const { return const_iterator(data_.data(), layout_, width_, height_); }
+    const_iterator end()   const { return const_iterator(data_.data(), layout_, width_, height_, size()); }
 
-    //    BK_ASSERT(pb.x < width_);
-    //    BK_ASSERT(pb.y < height_);
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend()   const { return end(); }
 
-    //    //the recct formed by pa and pb is exclusive of pb; make the iterator
-    //    //point to one element past the last element.
-    //    --pb.y;
+    //--------------------------------------------------------------------------
+    //! Views; only available for layouts with contiguous rows.
+    //--------------------------------------------------------------------------
+    using view_type       = grid_view<T>;
+    using const_view_type = grid_view<T const>;
 
-    //    return sub_iterator(data_.begin(), index2d_to_index_(pb), 0, 0, 0);
-    //}
-    //
-    iterator begin() { return iterator(data_.begin(), width_, height_); }
-    iterator end()   { return iterator(data_.end(), width_, height_); }
+    view_type view() {
+        return view({0, 0}, width_, height_);
+    }
 
-    const_iterator begin() const { return const_iterator(data_.begin(), width_, height_); }
-    const_iterator end()   const { return const_iterator(data_.end(), width_, height_); }
+    const_view_type view() const {
+        return view({0, 0}, width_, height_);
+    }
 
-    const_iterator cbegin() const { return begin(); }
-    const_iterator cend()   const { return end(); }
+    //! @returns A view of size w x h whose top left is at @c i.
+    view_type view(index i, size_t const w, size_t const h) {
+        static_assert(Layout::has_contiguous_rows, "layout doesn't support views.");
+        BK_ASSERT(i.x + w <= width_);
+        BK_ASSERT(i.y + h <= height_);
+
+        dirty_.mark(i, w, h);
+
+        return view_type {data_.data() + layout_.to_index(i.x, i.y), w, h, width_};
+    }
+
+    const_view_type view(index i, size_t const w, size_t const h) const {
+        static_assert(Layout::has_contiguous_rows, "layout doesn't support views.");
+        BK_ASSERT(i.x + w <= width_);
+        BK_ASSERT(i.y + h <= height_);
+
+        return const_view_type {data_.data() + layout_.to_index(i.x, i.y), w, h, width_};
+    }
+
+    //! @returns A range over each row as a grid_row<T>; the fastest way to
+    //! visit every element when the position is also required.
+    grid_row_range<T> rows() {
+        return view().rows();
+    }
+
+    grid_row_range<T const> rows() const {
+        return view().rows();
+    }
+
+    //! Copy all of @c src to the region whose top left is @c i.
+    void blit(index i, const_view_type const src) {
+        tez::blit(src, view(i, src.width(), src.height()));
+    }
+
+    //! Copy the elements of @c src for which mask(element) is true to the
+    //! region whose top left is @c i.
+    template <typename Mask>
+    void blit(index i, const_view_type const src, Mask mask) {
+        tez::blit(src, view(i, src.width(), src.height()), std::move(mask));
+    }
+
+    //--------------------------------------------------------------------------
+    //! Dirty region tracking.
+    //--------------------------------------------------------------------------
+    //! Start recording writes in blocks of block_size x block_size; clears
+    //! any existing record.
+    void enable_dirty_tracking(size_t const block_size = 16) {
+        dirty_ = dirty_map {width_, height_, block_size};
+    }
+
+    void disable_dirty_tracking() {
+        dirty_ = dirty_map {};
+    }
+
+    bool is_tracking_dirty() const BK_NOEXCEPT { return dirty_.enabled(); }
+
+    //! The record of written blocks; query with is_dirty(), count() and
+    //! for_each().
+    dirty_map const& dirty() const BK_NOEXCEPT { return dirty_; }
+
+    //! Explicitly mark a region as written.
+    void mark_dirty(index i, size_t const w = 1, size_t const h = 1) {
+        dirty_.mark(i, w, h);
+    }
+
+    //! Forget all writes recorded so far.
+    void clear_dirty() BK_NOEXCEPT { dirty_.clear(); }
 private:
     size_t index2d_to_index_(index i) const BK_NOEXCEPT {
         BK_ASSERT(is_valid(i));
-        return i.y * width_ + i.x;
+        return layout_.to_index(i.x, i.y);
     }
 
-    index_t width_;
-    index_t height_;
+    index_t        width_;
+    index_t        height_;
+    Layout         layout_;
     std::vector<T> data_;
+    dirty_map      dirty_;
 };
 //==============================================================================
 
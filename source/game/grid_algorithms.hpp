@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "assert.hpp"
+#include "thread_pool.hpp"
+
+#include "grid2d.hpp"
+
+namespace tez {
+
+//==============================================================================
+//! Parallel algorithms over grids.
+//!
+//! The grid is split into horizontal bands of whole rows which are processed
+//! on a thread_pool. The band layout depends only on the grid height, never
+//! on the number of threads, and partial results are combined in band order;
+//! results are therefore identical for any pool size.
+//!
+//! Each algorithm takes either a grid_view or a grid2d; mutable grids are
+//! written through view(), which also marks them dirty.
+//==============================================================================
+namespace detail {
+    //! Default number of bands a grid is split into.
+    size_t const DEFAULT_BAND_COUNT = 64;
+
+    //! [first, last) row range of band @c i out of @c n over @c h rows.
+    inline std::pair<size_t, size_t> band_rows(size_t const i, size_t const n, size_t const h) BK_NOEXCEPT {
+        return {(h * i) / n, (h * (i + 1)) / n};
+    }
+
+    inline size_t band_count(size_t const h, size_t const bands) BK_NOEXCEPT {
+        return std::min(h, bands ? bands : DEFAULT_BAND_COUNT);
+    }
+
+    //! The result of one band; wrapped so that a std::vector of them is never
+    //! std::vector<bool>, whose elements share words and can't be written
+    //! concurrently.
+    template <typename Value>
+    struct band_value {
+        Value value;
+    };
+} //namespace detail
+
+//==============================================================================
+//! Call f(grid_row<T>) for every row of @c v.
+//==============================================================================
+template <typename T, typename F>
+void parallel_for_rows(
+    bklib::thread_pool& pool
+  , grid_view<T> const  v
+  , F                   f
+  , size_t const        bands = 0
+) {
+    auto const n = detail::band_count(v.height(), bands);
+
+    pool.for_each_index(n, [&](size_t const i) {
+        auto const r = detail::band_rows(i, n, v.height());
+        for (auto y = r.first; y < r.second; ++y) {
+            f(grid_row<T> {y, v.row(y)});
+        }
+    });
+}
+
+template <typename T, typename Layout, typename F>
+void parallel_for_rows(bklib::thread_pool& pool, grid2d<T, Layout>& g, F f, size_t const bands = 0) {
+    parallel_for_rows(pool, g.view(), std::move(f), bands);
+}
+//==============================================================================
+//! dest[i] = f(src[i]) for every element.
+//! @pre src and dest have the same dimensions.
+//==============================================================================
+template <typename T, typename U, typename F>
+void transform(
+    bklib::thread_pool& pool
+  , grid_view<T> const  src
+  , grid_view<U> const  dest
+  , F                   f
+  , size_t const        bands = 0
+) {
+    BK_ASSERT(src.width() == dest.width() && src.height() == dest.height());
+
+    parallel_for_rows(pool, src, [&](grid_row<T> const row) {
+        auto const out = dest.row(row.y);
+        for (size_t x = 0; x < row.values.size(); ++x) {
+            out[x] = f(row.values[x]);
+        }
+    }, bands);
+}
+
+template <typename T, typename L0, typename U, typename L1, typename F>
+void transform(
+    bklib::thread_pool&      pool
+  , grid2d<T, L0> const&     src
+  , grid2d<U, L1>&           dest
+  , F                        f
+  , size_t const             bands = 0
+) {
+    transform(pool, src.view(), dest.view(), std::move(f), bands);
+}
+//==============================================================================
+//! Reduce every element of @c v.
+//!
+//! Each band folds its elements in row-major order with
+//! value = accumulate(value, element) starting from @c identity; the band
+//! results are then folded in order with combine(value, band_value).
+//!
+//! @param identity Must be an identity element for @c combine.
+//==============================================================================
+template <typename T, typename Value, typename Accumulate, typename Combine>
+Value reduce(
+    bklib::thread_pool& pool
+  , grid_view<T> const  v
+  , Value const         identity
+  , Accumulate          accumulate
+  , Combine             combine
+  , size_t const        bands = 0
+) {
+    auto const n = detail::band_count(v.height(), bands);
+
+    std::vector<detail::band_value<Value>> partial(n, detail::band_value<Value> {identity});
+
+    pool.for_each_index(n, [&](size_t const i) {
+        auto const r = detail::band_rows(i, n, v.height());
+
+        auto value = identity;
+        for (auto y = r.first; y < r.second; ++y) {
+            for (auto const& e : v.row(y)) {
+                value = accumulate(value, e);
+            }
+        }
+
+        partial[i].value = value;
+    });
+
+    auto result = identity;
+    for (auto const& p : partial) {
+        result = combine(result, p.value);
+    }
+
+    return result;
+}
+
+template <typename T, typename Layout, typename Value, typename Accumulate, typename Combine>
+Value reduce(
+    bklib::thread_pool&      pool
+  , grid2d<T, Layout> const& g
+  , Value const              identity
+  , Accumulate               accumulate
+  , Combine                  combine
+  , size_t const             bands = 0
+) {
+    return reduce(pool, g.view(), identity, std::move(accumulate), std::move(combine), bands);
+}
+//==============================================================================
+//! @returns The number of elements for which pred(element) is true.
+//==============================================================================
+template <typename T, typename Predicate>
+size_t count_if(
+    bklib::thread_pool& pool
+  , grid_view<T> const  v
+  , Predicate           pred
+  , size_t const        bands = 0
+) {
+    return reduce(pool, v, size_t {0}
+      , [&](size_t const n, T const& e) { return n + (pred(e) ? 1 : 0); }
+      , [](size_t const a, size_t const b) { return a + b; }
+      , bands
+    );
+}
+
+template <typename T, typename Layout, typename Predicate>
+size_t count_if(bklib::thread_pool& pool, grid2d<T, Layout> const& g, Predicate pred, size_t const bands = 0) {
+    return count_if(pool, g.view(), std::move(pred), bands);
+}
+
+} //namespace tez
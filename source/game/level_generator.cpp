@@ -0,0 +1,96 @@
+#include "pch.hpp"
+
+#include "level_generator.hpp"
+#include "corridors.hpp"
+
+using level_generator = tez::level_generator;
+
+namespace {
+//==============================================================================
+//! The splitmix64 finalizer; a bijective hash of 64 bits.
+//==============================================================================
+uint64_t mix64(uint64_t x) BK_NOEXCEPT {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+} //namespace
+
+//==============================================================================
+tez::random level_generator::make_stream(uint64_t const master_seed, uint64_t const index) {
+    auto const a = mix64(master_seed);
+    auto const b = mix64(a ^ mix64(index));
+
+    std::seed_seq seq {
+        static_cast<uint32_t>(a), static_cast<uint32_t>(a >> 32)
+      , static_cast<uint32_t>(b), static_cast<uint32_t>(b >> 32)
+    };
+
+    return random {seq};
+}
+
+//==============================================================================
+level_generator::level level_generator::generate(random& rand) const {
+    auto room_gen = generator::room_simple {params_.room_width, params_.room_height};
+    generator::layout_random layout;
+
+    auto const budget = generator::placement_budget {params_.placement_attempts};
+
+    //rooms are generated directly into a single buffer sized for the mean.
+    layout.reserve(params_.room_count, params_.room_count * room_gen.expected_area());
+
+    for (size_t i = 0; i < params_.room_count; ++i) {
+        layout.try_generate(rand, room_gen, budget);
+    }
+    layout.normalize();
+
+    auto result = layout.to_grid();
+
+    if (params_.connect_rooms) {
+        auto const corridors = generator::corridors {params_.extra_corridors};
+        auto const links     = corridors.connect(layout.rects_, rand);
+        corridors.carve(result, layout.rects_, links, rand);
+    }
+
+    return result;
+}
+
+level_generator::level level_generator::generate(uint64_t const master_seed, uint64_t const index) const {
+    auto rand = make_stream(master_seed, index);
+    return generate(rand);
+}
+
+std::vector<level_generator::level> level_generator::generate_batch(
+    bklib::thread_pool& pool
+  , uint64_t const      master_seed
+  , uint64_t const      first
+  , size_t const        n
+) const {
+    std::vector<std::future<level>> jobs;
+    jobs.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        auto const index = first + i;
+        jobs.emplace_back(pool.submit([this, master_seed, index] {
+            return generate(master_seed, index);
+        }));
+    }
+
+    //wait for every job before any exception leaves; they refer to this.
+    std::vector<level> result;
+    result.reserve(n);
+
+    std::exception_ptr error;
+    for (auto& job : jobs) {
+        try {
+            result.emplace_back(job.get());
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+
+    return result;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+
+#include "config.hpp"
+#include "assert.hpp"
+#include "thread_pool.hpp"
+
+#include "tile_data.hpp"
+#include "grid2d.hpp"
+#include "room.hpp"
+
+namespace tez {
+
+//==============================================================================
+//! Builds complete levels: rooms, their layout, the final grid and the
+//! corridors connecting the rooms.
+//!
+//! Levels are a pure function of the random engine passed in; batches derive
+//! an independent engine for each level from a master seed and the level's
+//! index, so a batch is identical however many threads build it.
+//==============================================================================
+class level_generator {
+public:
+    using level = grid2d<tile_data>;
+    using range = generator::room_simple::range;
+
+    struct params {
+        params()
+          : room_count{100}, room_width{3, 10}, room_height{3, 10}
+          , connect_rooms{true}, extra_corridors{0.15f}
+          , placement_attempts{generator::placement_budget::DEFAULT_ATTEMPTS}
+        {
+        }
+
+        size_t room_count;
+        range  room_width;
+        range  room_height;
+        bool   connect_rooms;   //!< carve corridors between rooms.
+        float  extra_corridors; //!< @see generator::corridors.
+
+        //! Rooms which can't be placed within this many attempts are dropped.
+        uint32_t placement_attempts;
+    };
+
+    explicit level_generator(params p = params {})
+      : params_(p)
+    {
+    }
+
+    //! Build a level drawing every random value from @c rand.
+    level generate(random& rand) const;
+
+    //! Build the level for stream @c index of @c master_seed.
+    level generate(uint64_t master_seed, uint64_t index) const;
+
+    //! Build the levels for streams [first, first + n) of @c master_seed on
+    //! @c pool; the result is in stream order.
+    std::vector<level> generate_batch(
+        bklib::thread_pool& pool
+      , uint64_t            master_seed
+      , uint64_t            first
+      , size_t              n
+    ) const;
+
+    //! @returns An engine for stream @c index of @c master_seed; streams are
+    //! seeded from a hash of both so neighbouring indices are unrelated.
+    static random make_stream(uint64_t master_seed, uint64_t index);
+private:
+    params params_;
+};
+
+} //namespace tez
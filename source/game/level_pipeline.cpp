@@ -0,0 +1,51 @@
+#include "pch.hpp"
+
+#include "level_pipeline.hpp"
+
+using level_pipeline = tez::level_pipeline;
+
+//==============================================================================
+level_pipeline::level_pipeline(
+    level_generator gen
+  , uint64_t const  master_seed
+  , uint64_t const  first
+)
+  : generator_(std::move(gen))
+  , master_seed_{master_seed}
+  , next_{first}
+  , worker_{1}
+{
+    start_();
+}
+
+//==============================================================================
+bool level_pipeline::is_ready() const {
+    BK_ASSERT(pending_.valid());
+    return pending_.wait_for(std::chrono::seconds {0}) == std::future_status::ready;
+}
+
+level_pipeline::level level_pipeline::take() {
+    BK_ASSERT(pending_.valid());
+
+    //start the next level even if this one failed.
+    auto current = std::move(pending_);
+    ++next_;
+    start_();
+
+    return current.get();
+}
+
+bool level_pipeline::try_take(level& out) {
+    if (!is_ready()) return false;
+
+    out = take();
+    return true;
+}
+
+//==============================================================================
+void level_pipeline::start_() {
+    auto const index = next_;
+    pending_ = worker_.submit([this, index] {
+        return generator_.generate(master_seed_, index);
+    });
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <future>
+
+#include "config.hpp"
+#include "assert.hpp"
+#include "thread_pool.hpp"
+
+#include "level_generator.hpp"
+
+namespace tez {
+
+//==============================================================================
+//! Generates levels one ahead on a background thread.
+//!
+//! Levels are streams first, first + 1, ... of a master seed; as soon as a
+//! level is taken the next is started so that, given enough time between
+//! transitions, taking a level never waits. Only one thread may use a
+//! pipeline at a time.
+//==============================================================================
+class level_pipeline {
+public:
+    using level = level_generator::level;
+
+    //No implicit copies
+    level_pipeline(level_pipeline const&) = delete;
+    level_pipeline& operator=(level_pipeline const&) = delete;
+
+    //! Starts generating level @c first immediately.
+    level_pipeline(level_generator gen, uint64_t master_seed, uint64_t first = 0);
+
+    //! @returns Whether take() would return without waiting.
+    bool is_ready() const;
+
+    //! @returns The pending level, waiting if required; starts the next.
+    level take();
+
+    //! If the pending level is ready move it to @c out and start the next.
+    //! @returns Whether a level was taken; never waits.
+    bool try_take(level& out);
+
+    //! The stream index of the pending level.
+    uint64_t pending_index() const BK_NOEXCEPT { return next_; }
+private:
+    void start_();
+
+    level_generator    generator_;
+    uint64_t           master_seed_;
+    uint64_t           next_;
+    std::future<level> pending_;
+    //Destroyed first; waits for the job using generator_.
+    bklib::thread_pool worker_;
+};
+
+} //namespace tez
@@ -0,0 +1,334 @@
+#include "pch.hpp"
+
+#include "noise.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define BK_NOISE_SSE2
+#   include <emmintrin.h>
+#endif
+
+//the scalar and vector paths must round identically; keep a * b + c unfused.
+#if defined(__clang__)
+#   pragma clang fp contract(off)
+#elif defined(BK_COMPILER_MSVC)
+#   pragma fp_contract(off)
+#elif defined(__GNUC__)
+#   pragma GCC optimize("fp-contract=off")
+#endif
+
+using simplex_noise = tez::simplex_noise;
+using noise_params  = tez::noise_params;
+
+namespace {
+//==============================================================================
+//! Skew and unskew factors; (sqrt(3) - 1) / 2 and (3 - sqrt(3)) / 6.
+//==============================================================================
+float const F2 = 0.366025403784438646763723170753f;
+float const G2 = 0.211324865405187117745425609749f;
+float const G2_2_MINUS_1 = 2.0f * G2 - 1.0f;
+
+//! Scales the sum of the corner contributions into about [-1, 1].
+float const SCALE = 70.0f;
+
+//! Offset between octaves so they do not share a lattice origin.
+float const OCTAVE_OFFSET_X = 131.7f;
+float const OCTAVE_OFFSET_Y =  71.3f;
+
+//! Gradient directions indexed by hash & 7.
+float const GRAD_X[8] = {1.0f, -1.0f,  1.0f, -1.0f, 1.0f, -1.0f, 0.0f,  0.0f};
+float const GRAD_Y[8] = {1.0f,  1.0f, -1.0f, -1.0f, 0.0f,  0.0f, 1.0f, -1.0f};
+
+int32_t floor_to_int(float const x) BK_NOEXCEPT {
+    auto const i = static_cast<int32_t>(x);
+    return (x < static_cast<float>(i)) ? i - 1 : i;
+}
+
+//! The contribution of a single corner at offset (x, y) with gradient g.
+float corner(float const x, float const y, float const gx, float const gy) BK_NOEXCEPT {
+    auto t = (0.5f - x * x) - y * y;
+    t = (t > 0.0f) ? t : 0.0f; //as maxps; std::max keeps -0.
+
+    auto const t2 = t * t;
+    return (t2 * t2) * (gx * x + gy * y);
+}
+
+uint8_t to_byte(float const v) BK_NOEXCEPT {
+    return static_cast<uint8_t>(static_cast<int32_t>((v + 1.0f) * 127.5f + 0.5f));
+}
+
+} //namespace
+
+//==============================================================================
+//! Per octave values shared by the scalar and vector paths.
+//==============================================================================
+struct simplex_noise::octaves {
+    explicit octaves(noise_params const& p) BK_NOEXCEPT
+      : count {p.octaves < noise_params::MAX_OCTAVES ? p.octaves : noise_params::MAX_OCTAVES}
+    {
+        BK_ASSERT(p.octaves > 0);
+
+        auto f = p.frequency;
+        auto a = 1.0f;
+        auto sum = 0.0f;
+
+        for (unsigned i = 0; i < count; ++i) {
+            frequency[i] = f;
+            amplitude[i] = a;
+            offset_x[i]  = OCTAVE_OFFSET_X * static_cast<float>(i);
+            offset_y[i]  = OCTAVE_OFFSET_Y * static_cast<float>(i);
+
+            sum += a;
+            f *= p.lacunarity;
+            a *= p.gain;
+        }
+
+        normalize = 1.0f / sum;
+    }
+
+    unsigned count;
+    float    frequency[noise_params::MAX_OCTAVES];
+    float    amplitude[noise_params::MAX_OCTAVES];
+    float    offset_x[noise_params::MAX_OCTAVES];
+    float    offset_y[noise_params::MAX_OCTAVES];
+    float    normalize;
+};
+
+//==============================================================================
+bool simplex_noise::has_simd() BK_NOEXCEPT {
+#if defined(BK_NOISE_SSE2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+//==============================================================================
+simplex_noise::simplex_noise(uint32_t const seed) {
+    //Fisher-Yates on the raw engine output; std::shuffle and the standard
+    //distributions are not reproducible between library implementations.
+    std::mt19937 rand {seed};
+
+    for (size_t i = 0; i < 256; ++i) {
+        perm_[i] = static_cast<uint8_t>(i);
+    }
+
+    for (size_t i = 255; i > 0; --i) {
+        auto const j = static_cast<size_t>(rand() % (i + 1));
+        std::swap(perm_[i], perm_[j]);
+    }
+
+    std::copy(perm_.begin(), perm_.begin() + 256, perm_.begin() + 256);
+}
+
+//==============================================================================
+float simplex_noise::at(float const x, float const y) const BK_NOEXCEPT {
+    //the simplex cell containing (x, y).
+    auto const s = (x + y) * F2;
+    auto const i = floor_to_int(x + s);
+    auto const j = floor_to_int(y + s);
+
+    auto const t  = static_cast<float>(i + j) * G2;
+    auto const x0 = x - (static_cast<float>(i) - t);
+    auto const y0 = y - (static_cast<float>(j) - t);
+
+    //the middle corner; (1, 0) for the lower triangle, (0, 1) for the upper.
+    auto const i1 = (x0 > y0) ? 1 : 0;
+    auto const j1 = 1 - i1;
+
+    auto const x1 = (x0 - static_cast<float>(i1)) + G2;
+    auto const y1 = (y0 - static_cast<float>(j1)) + G2;
+    auto const x2 = x0 + G2_2_MINUS_1;
+    auto const y2 = y0 + G2_2_MINUS_1;
+
+    auto const ii = static_cast<size_t>(i & 0xFF);
+    auto const jj = static_cast<size_t>(j & 0xFF);
+
+    auto const h0 = perm_[ii      + perm_[jj     ]] & 7;
+    auto const h1 = perm_[ii + i1 + perm_[jj + j1]] & 7;
+    auto const h2 = perm_[ii + 1  + perm_[jj + 1 ]] & 7;
+
+    auto const n0 = corner(x0, y0, GRAD_X[h0], GRAD_Y[h0]);
+    auto const n1 = corner(x1, y1, GRAD_X[h1], GRAD_Y[h1]);
+    auto const n2 = corner(x2, y2, GRAD_X[h2], GRAD_Y[h2]);
+
+    auto const n = SCALE * ((n0 + n1) + n2);
+    return std::min(std::max(n, -1.0f), 1.0f);
+}
+
+float simplex_noise::at(float const x, float const y, noise_params const& p) const BK_NOEXCEPT {
+    float result;
+    fill_row_(&result, 1, x, y, octaves {p}, false);
+    return result;
+}
+
+//==============================================================================
+void simplex_noise::fill(
+    grid_view<float> const out
+  , noise_params const&    p
+  , float const            x0
+  , float const            y0
+  , bool const             vectorize
+) const {
+    auto const o = octaves {p};
+
+    for (auto const row : out.rows()) {
+        auto const y = y0 + static_cast<float>(row.y);
+        fill_row_(row.values.data(), row.values.size(), x0, y, o, vectorize);
+    }
+}
+
+void simplex_noise::fill(
+    grid_view<uint8_t> const out
+  , noise_params const&      p
+  , float const              x0
+  , float const              y0
+  , bool const               vectorize
+) const {
+    auto const o = octaves {p};
+    std::vector<float> values(out.width());
+
+    for (auto const row : out.rows()) {
+        auto const y = y0 + static_cast<float>(row.y);
+        fill_row_(values.data(), values.size(), x0, y, o, vectorize);
+
+        std::transform(std::begin(values), std::end(values), row.values.data(), to_byte);
+    }
+}
+
+//==============================================================================
+#if defined(BK_NOISE_SSE2)
+namespace {
+
+__m128 floor4(__m128 const x, __m128i& i) BK_NOEXCEPT {
+    auto const t = _mm_cvttps_epi32(x);
+    auto const f = _mm_cvtepi32_ps(t);
+
+    //-1 where truncation rounded up.
+    auto const up = _mm_castps_si128(_mm_cmplt_ps(x, f));
+
+    i = _mm_add_epi32(t, up);
+    return _mm_cvtepi32_ps(i);
+}
+
+__m128 corner4(__m128 const x, __m128 const y, __m128 const gx, __m128 const gy) BK_NOEXCEPT {
+    auto t = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, x)), _mm_mul_ps(y, y));
+    t = _mm_max_ps(t, _mm_setzero_ps());
+
+    auto const t2  = _mm_mul_ps(t, t);
+    auto const dot = _mm_add_ps(_mm_mul_ps(gx, x), _mm_mul_ps(gy, y));
+
+    return _mm_mul_ps(_mm_mul_ps(t2, t2), dot);
+}
+
+//! Four lanes of simplex_noise::at; the same operations in the same order.
+__m128 simplex4(uint8_t const* const perm, __m128 const x, __m128 const y) BK_NOEXCEPT {
+    auto const s = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(F2));
+
+    __m128i i;
+    __m128i j;
+    auto const fi = floor4(_mm_add_ps(x, s), i);
+    auto const fj = floor4(_mm_add_ps(y, s), j);
+
+    auto const t  = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), _mm_set1_ps(G2));
+    auto const x0 = _mm_sub_ps(x, _mm_sub_ps(fi, t));
+    auto const y0 = _mm_sub_ps(y, _mm_sub_ps(fj, t));
+
+    auto const lower = _mm_cmpgt_ps(x0, y0);
+    auto const one   = _mm_set1_ps(1.0f);
+    auto const i1    = _mm_and_ps(lower, one);
+    auto const j1    = _mm_andnot_ps(lower, one);
+
+    auto const g2 = _mm_set1_ps(G2);
+    auto const x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g2);
+    auto const y1 = _mm_add_ps(_mm_sub_ps(y0, j1), g2);
+    auto const x2 = _mm_add_ps(x0, _mm_set1_ps(G2_2_MINUS_1));
+    auto const y2 = _mm_add_ps(y0, _mm_set1_ps(G2_2_MINUS_1));
+
+    //the hashes are looked up a lane at a time; SSE2 has no gather.
+    int32_t is[4];
+    int32_t js[4];
+    int32_t ls[4];
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(is), i);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(js), j);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ls), _mm_castps_si128(lower));
+
+    float gx[3][4];
+    float gy[3][4];
+
+    for (int k = 0; k < 4; ++k) {
+        auto const ii  = static_cast<size_t>(is[k] & 0xFF);
+        auto const jj  = static_cast<size_t>(js[k] & 0xFF);
+        auto const di1 = ls[k] ? 1u : 0u;
+        auto const dj1 = 1u - di1;
+
+        auto const h0 = perm[ii       + perm[jj      ]] & 7;
+        auto const h1 = perm[ii + di1 + perm[jj + dj1]] & 7;
+        auto const h2 = perm[ii + 1   + perm[jj + 1  ]] & 7;
+
+        gx[0][k] = GRAD_X[h0]; gy[0][k] = GRAD_Y[h0];
+        gx[1][k] = GRAD_X[h1]; gy[1][k] = GRAD_Y[h1];
+        gx[2][k] = GRAD_X[h2]; gy[2][k] = GRAD_Y[h2];
+    }
+
+    auto const n0 = corner4(x0, y0, _mm_loadu_ps(gx[0]), _mm_loadu_ps(gy[0]));
+    auto const n1 = corner4(x1, y1, _mm_loadu_ps(gx[1]), _mm_loadu_ps(gy[1]));
+    auto const n2 = corner4(x2, y2, _mm_loadu_ps(gx[2]), _mm_loadu_ps(gy[2]));
+
+    auto const n = _mm_mul_ps(_mm_set1_ps(SCALE), _mm_add_ps(_mm_add_ps(n0, n1), n2));
+    return _mm_min_ps(_mm_max_ps(n, _mm_set1_ps(-1.0f)), one);
+}
+
+} //namespace
+#endif
+
+void simplex_noise::fill_row_(
+    float* const    out
+  , size_t const    n
+  , float const     x0
+  , float const     y
+  , octaves const&  o
+  , bool const      vectorize
+) const {
+    size_t x = 0;
+
+#if defined(BK_NOISE_SSE2)
+    if (vectorize) {
+        auto const lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+        for (; x + 4 <= n; x += 4) {
+            auto const px = _mm_add_ps(_mm_set1_ps(x0), _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lanes));
+            auto const py = _mm_set1_ps(y);
+
+            auto total = _mm_setzero_ps();
+            for (unsigned i = 0; i < o.count; ++i) {
+                auto const f  = _mm_set1_ps(o.frequency[i]);
+                auto const sx = _mm_add_ps(_mm_mul_ps(px, f), _mm_set1_ps(o.offset_x[i]));
+                auto const sy = _mm_add_ps(_mm_mul_ps(py, f), _mm_set1_ps(o.offset_y[i]));
+
+                auto const v = simplex4(perm_.data(), sx, sy);
+                total = _mm_add_ps(total, _mm_mul_ps(_mm_set1_ps(o.amplitude[i]), v));
+            }
+
+            _mm_storeu_ps(out + x, _mm_mul_ps(total, _mm_set1_ps(o.normalize)));
+        }
+    }
+#else
+    BK_UNUSED(vectorize);
+#endif
+
+    for (; x < n; ++x) {
+        //x + lane is exact in both paths for any row narrower than 2^24.
+        auto const px = x0 + static_cast<float>(x);
+
+        auto total = 0.0f;
+        for (unsigned i = 0; i < o.count; ++i) {
+            auto const sx = px * o.frequency[i] + o.offset_x[i];
+            auto const sy = y  * o.frequency[i] + o.offset_y[i];
+
+            total = total + o.amplitude[i] * at(sx, sy);
+        }
+
+        out[x] = total * o.normalize;
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+
+#include "config.hpp"
+#include "types.hpp"
+#include "assert.hpp"
+
+#include "grid2d.hpp"
+
+namespace tez {
+
+//==============================================================================
+//! Parameters for fractal noise: octave i is sampled at
+//! frequency * lacunarity^i and weighted by gain^i; the sum is normalized
+//! back into [-1, 1].
+//==============================================================================
+struct noise_params {
+    //! The most octaves a fill will use.
+    static unsigned const MAX_OCTAVES = 16;
+
+    noise_params() BK_NOEXCEPT
+      : octaves    {4}
+      , frequency  {1.0f / 32.0f}
+      , lacunarity {2.0f}
+      , gain       {0.5f}
+    {
+    }
+
+    unsigned octaves;
+    float    frequency;
+    float    lacunarity;
+    float    gain;
+};
+
+//==============================================================================
+//! Seeded 2D simplex noise.
+//!
+//! Bulk fills are vectorized with SSE2 where available, four samples at a
+//! time, and fall back to scalar code otherwise. Both paths perform the same
+//! floating point operations in the same order, so a seed gives bit identical
+//! output either way.
+//!
+//! Sample coordinates must lie within +/- 2^30 after scaling by frequency.
+//==============================================================================
+class simplex_noise {
+public:
+    //! @returns Whether fill() can use the vectorized path in this build.
+    static bool has_simd() BK_NOEXCEPT;
+
+    explicit simplex_noise(uint32_t seed);
+
+    //! A single octave at (x, y); in [-1, 1].
+    float at(float x, float y) const BK_NOEXCEPT;
+
+    //! Fractal noise at (x, y); in [-1, 1].
+    float at(float x, float y, noise_params const& p) const BK_NOEXCEPT;
+
+    //! Fill @c out with fractal noise; element (x, y) is at(x0 + x, y0 + y, p).
+    //! @param vectorize Whether to use the vectorized path if available; the
+    //!                  result is the same either way.
+    void fill(
+        grid_view<float>    out
+      , noise_params const& p
+      , float               x0 = 0.0f
+      , float               y0 = 0.0f
+      , bool                vectorize = true
+    ) const;
+
+    //! As above, with [-1, 1] mapped onto [0, 255].
+    void fill(
+        grid_view<uint8_t>  out
+      , noise_params const& p
+      , float               x0 = 0.0f
+      , float               y0 = 0.0f
+      , bool                vectorize = true
+    ) const;
+
+    template <typename T, typename Layout>
+    void fill(
+        grid2d<T, Layout>&  out
+      , noise_params const& p
+      , float const         x0 = 0.0f
+      , float const         y0 = 0.0f
+      , bool const          vectorize = true
+    ) const {
+        fill(out.view(), p, x0, y0, vectorize);
+    }
+private:
+    struct octaves;
+
+    //! Fill @c out with @c n samples along a row starting at (x0, y).
+    void fill_row_(float* out, size_t n, float x0, float y, octaves const& o, bool vectorize) const;
+
+    std::array<uint8_t, 512> perm_; //!< a permutation of [0, 256) repeated twice.
+};
+
+} //namespace tez
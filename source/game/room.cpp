@@ -28,8 +28,90 @@ room& room::operator=(room&& rhs)
 }
 
 void room::swap(room& other) {
+    grid2d::swap(other);
+}
+
+//==============================================================================
+using room_store = tez::room_store;
+
+room_store::room_store(room_store&& other)
+  : rooms_(std::move(other.rooms_))
+  , tiles_(std::move(other.tiles_))
+  , capacity_ {other.capacity_}
+  , used_ {other.used_}
+{
+    other.capacity_ = 0;
+    other.used_     = 0;
+}
+
+room_store& room_store::operator=(room_store&& rhs) {
+    rhs.swap(*this);
+    return *this;
+}
+
+void room_store::swap(room_store& other) {
     using std::swap;
-    swap(*this, other);
+    swap(rooms_,    other.rooms_);
+    swap(tiles_,    other.tiles_);
+    swap(capacity_, other.capacity_);
+    swap(used_,     other.used_);
+}
+
+void room_store::reserve(size_t const rooms, size_t const tiles) {
+    rooms_.reserve(rooms);
+
+    if (tiles > capacity_) {
+        grow_(tiles);
+    }
+}
+
+void room_store::grow_(size_t const n) {
+    auto const capacity = std::max(n, 2 * capacity_);
+
+    std::unique_ptr<tile_data, free_tiles> tiles {
+        static_cast<tile_data*>(::operator new(capacity * sizeof(tile_data)))
+    };
+
+    if (used_) {
+        std::memcpy(tiles.get(), tiles_.get(), used_ * sizeof(tile_data));
+    }
+
+    tiles_    = std::move(tiles);
+    capacity_ = capacity;
+}
+
+room_store::view_type room_store::add(size_t const w, size_t const h, tile_data const value) {
+    auto const n = w * h;
+
+    if (used_ + n > capacity_) {
+        grow_(used_ + n);
+    }
+
+    std::uninitialized_fill_n(tiles_.get() + used_, n, value);
+
+    rooms_.push_back(entry {used_, w, h});
+    used_ += n;
+
+    return (*this)[rooms_.size() - 1];
+}
+
+room_store::view_type room_store::add(const_view_type const src) {
+    auto const result = add(src.width(), src.height());
+    tez::blit(src, result);
+
+    return result;
+}
+
+void room_store::pop_back() {
+    BK_ASSERT(!rooms_.empty());
+
+    used_ = rooms_.back().offset;
+    rooms_.pop_back();
+}
+
+void room_store::clear() {
+    rooms_.clear();
+    used_ = 0;
 }
 
 //==============================================================================
@@ -41,31 +123,286 @@ room room_simple::generate(random& rand) {
 
     return room_simple_fixed{w, h}.generate(rand);
 }
+
+room_store::view_type room_simple::generate(random& rand, room_store& out) {
+    auto const w = width_(rand);
+    auto const h = height_(rand);
+
+    return room_simple_fixed{w, h}.generate(rand, out);
+}
 //==============================================================================
 using room_simple_fixed = tez::generator::room_simple_fixed;
 
+namespace {
+    //! Floor surrounded by a wall one tile thick.
+    void draw_simple_room(tez::grid_view<tez::tile_data> const v) {
+        using tez::tile_type;
+
+        auto const w = v.width();
+        auto const h = v.height();
+
+        auto edge_y = [&](size_t const y) {
+            for (size_t x = 0; x < w; ++x) {
+                v[{x, y}].type = tile_type::wall;
+            }
+        };
+
+        auto edge_x = [&](size_t const y) {
+            for (auto const x : {size_t {0}, w - 1}) {
+                v[{x, y}].type = tile_type::wall;
+            }
+        };
+
+        edge_y(0);
+        for (size_t y = 1; y < h - 1; ++y) edge_x(y);
+        edge_y(h - 1);
+    }
+} //namespace
+
 room room_simple_fixed::generate(random& rand) const {
     BK_UNUSED(rand);
 
-    auto const value = tez::tile_data{tez::tile_type::floor};
+    auto result = room {width_, height_, tez::tile_data{tez::tile_type::floor}};
+    draw_simple_room(result.view());
 
-    auto result = room {width_, height_, value};
+    return result;
+}
 
-    auto edge_y = [&](unsigned const y) {
-        for (auto x = 0u; x < width_; ++x) {
-            result[{x, y}].type = tile_type::wall;
-        }
+room_store::view_type room_simple_fixed::generate(random& rand, room_store& out) const {
+    BK_UNUSED(rand);
+
+    auto const result = out.add(width_, height_, tez::tile_data{tez::tile_type::floor});
+    draw_simple_room(result);
+
+    return result;
+}
+//==============================================================================
+using room_cave = tez::generator::room_cave;
+
+tez::bitboard room_cave::generate_bits(random& rand) const {
+    using word_t = bitboard::word_t;
+
+    BK_ASSERT(density_ >= 0.0f && density_ <= 1.0f);
+
+    auto current = bitboard {width_, height_};
+    auto next    = bitboard {width_, height_};
+
+    //initial noise: 8 tiles from each 64 bit random value, comparing 7 bits
+    //per tile against the threshold a byte at a time. The noise comes from a
+    //cheap xorshift stream seeded from rand.
+    auto const lsb = word_t {0x0101010101010101ULL};
+    auto const msb = word_t {0x8080808080808080ULL};
+    auto const threshold = lsb * static_cast<word_t>(density_ * 128.0f);
+
+    //drawn in order; the operands of | are unsequenced.
+    auto const hi = uint64_t {rand()};
+    auto const lo = uint64_t {rand()};
+    auto state = (hi << 32 | lo) | 1;
+    auto const next_noise = [&] {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
     };
 
-    auto edge_x = [&](unsigned const y) {
-        for (auto const x : {0u, width_ - 1}) {
-            result[{x, y}].type = tile_type::wall;
+    for (size_t y = 0; y < height_; ++y) {
+        for (auto& w : current.row(y)) {
+            w = 0;
+            for (unsigned b = 0; b < bitboard::word_bits; b += 8) {
+                //the high bit of each byte is clear where the byte < threshold.
+                auto const ge   = ((next_noise() & ~msb) | msb) - threshold;
+                auto const rock = (~ge & msb) >> 7;
+                //gather the low bit of each byte into one byte.
+                w |= ((rock * 0x0102040810204080ULL) >> 56) << b;
+            }
         }
-    };
+    }
+    current.clear_padding();
+
+    //rock outside the cave keeps the edges closed.
+    for (unsigned i = 0; i < generations_; ++i) {
+        current.step(rule_, next, true);
+        current.swap(next);
+    }
+
+    for (size_t x = 0; x < width_; ++x) {
+        current.set({x, 0});
+        current.set({x, height_ - 1u});
+    }
+    for (size_t y = 0; y < height_; ++y) {
+        current.set({0, y});
+        current.set({width_ - 1u, y});
+    }
+
+    return current;
+}
+
+namespace {
+    //! Floor for open tiles and wall for rock next to them.
+    void draw_cave(tez::bitboard const& rock, tez::grid_view<tez::tile_data> const v) {
+        using tez::tile_type;
+
+        auto open = rock.clone();
+        open.invert();
+
+        auto walls = open.any_neighbour();
+        walls &= rock;
+
+        for (auto const& i : v) {
+            if (open[i.i]) {
+                i.value.type = tile_type::floor;
+            } else if (walls[i.i]) {
+                i.value.type = tile_type::wall;
+            }
+        }
+    }
+} //namespace
+
+room room_cave::generate(random& rand) const {
+    auto result = room {width_, height_};
+    draw_cave(generate_bits(rand), result.view());
+
+    return result;
+}
+
+room_store::view_type room_cave::generate(random& rand, room_store& out) const {
+    auto const rock   = generate_bits(rand);
+    auto const result = out.add(width_, height_);
+    draw_cave(rock, result);
+
+    return result;
+}
+//==============================================================================
+using layout_bsp = tez::generator::layout_bsp;
+
+void layout_bsp::generate(random& rand, room_simple& gen) {
+    using dist = std::uniform_int_distribution<int>;
+
+    nodes_.clear();
+    rects_.clear();
+    data_.clear();
+
+    //every leaf is at least min_leaf_ x min_leaf_.
+    auto const max_leaves = static_cast<size_t>((width_ / min_leaf_) * (height_ / min_leaf_));
+    nodes_.reserve(2 * max_leaves);
+
+    nodes_.push_back(node {rect {0, 0, width_, height_}, {-1, -1}, -1, false});
+
+    //breadth first; children are appended as they are created.
+    size_t leaves = 0;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        auto const area = nodes_[i].area;
+        auto const w = area.width();
+        auto const h = area.height();
+
+        auto const split_x = (w >= h);
+        auto const length  = split_x ? w : h;
+
+        if (length < 2 * min_leaf_) {
+            ++leaves;
+            continue;
+        }
+
+        auto const at = dist {min_leaf_, length - min_leaf_}(rand);
+
+        auto const a = split_x
+          ? rect {area.left(), area.top(), area.left() + at, area.bottom()}
+          : rect {area.left(), area.top(), area.right(), area.top() + at};
+        auto const b = split_x
+          ? rect {area.left() + at, area.top(), area.right(), area.bottom()}
+          : rect {area.left(), area.top() + at, area.right(), area.bottom()};
 
-    edge_y(0);
-    for (auto y = 1u; y < height_ - 1; ++y) edge_x(y);
-    edge_y(height_ - 1);
+        auto const first = static_cast<int32_t>(nodes_.size());
+        nodes_[i].child[0] = first;
+        nodes_[i].child[1] = first + 1;
+        nodes_[i].split_x  = split_x;
+
+        nodes_.push_back(node {a, {-1, -1}, -1, false});
+        nodes_.push_back(node {b, {-1, -1}, -1, false});
+    }
+
+    //rooms clamped to their leaves only make this an overestimate.
+    rects_.reserve(leaves);
+    data_.reserve(leaves, leaves * gen.expected_area());
+
+    for (auto& n : nodes_) {
+        if (n.child[0] >= 0) continue;
+
+        //clamp the room to the leaf less a margin of 1 on each side.
+        auto const w = n.area.width();
+        auto const h = n.area.height();
+
+        auto const v  = gen.generate(rand, data_);
+        auto const rw = std::min<int>(static_cast<int>(v.width()),  w - 2);
+        auto const rh = std::min<int>(static_cast<int>(v.height()), h - 2);
+
+        if (rw != static_cast<int>(v.width()) || rh != static_cast<int>(v.height())) {
+            data_.pop_back();
+            room_simple_fixed {static_cast<unsigned>(rw), static_cast<unsigned>(rh)}.generate(rand, data_);
+        }
+
+        auto const x = n.area.left() + dist {1, w - rw - 1}(rand);
+        auto const y = n.area.top()  + dist {1, h - rh - 1}(rand);
+
+        n.room = static_cast<int32_t>(rects_.size());
+        rects_.push_back(rect {x, y, x + rw, y + rh});
+    }
+}
+
+size_t layout_bsp::nearest_room_(int32_t n, bool const split_x, bool const high) const {
+    //follow the child closer to the split while the splits are parallel.
+    while (nodes_[n].room < 0) {
+        auto const& cur = nodes_[n];
+        n = (cur.split_x == split_x) ? cur.child[high ? 1 : 0] : cur.child[0];
+    }
+
+    return static_cast<size_t>(nodes_[n].room);
+}
+
+std::vector<layout_bsp::link> layout_bsp::links() const {
+    std::vector<link> result;
+
+    for (auto const& n : nodes_) {
+        if (n.room >= 0) continue;
+
+        auto const a = nearest_room_(n.child[0], n.split_x, true);
+        auto const b = nearest_room_(n.child[1], n.split_x, false);
+        result.emplace_back(std::min(a, b), std::max(a, b));
+    }
+
+    return result;
+}
+
+//==============================================================================
+using placement_stats = tez::generator::placement_stats;
+
+std::vector<size_t> placement_stats::histogram(
+    std::vector<placement_stats> const& stats
+  , uint32_t placement_stats::* const   counter
+) {
+    std::vector<size_t> result;
+
+    for (auto const& s : stats) {
+        //floor(log2(value + 1))
+        size_t bucket = 0;
+        for (auto v = static_cast<uint64_t>(s.*counter) + 1; v > 1; v >>= 1) {
+            ++bucket;
+        }
+
+        if (bucket >= result.size()) {
+            result.resize(bucket + 1, 0);
+        }
+
+        ++result[bucket];
+    }
 
     return result;
 }
+
+void placement_stats::write_histogram(std::ostream& out, std::vector<size_t> const& buckets) {
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        auto const lo = (uint64_t {1} << i) - 1;
+        auto const hi = (uint64_t {1} << (i + 1)) - 2;
+        out << lo << "," << hi << "," << buckets[i] << "\n";
+    }
+}
@@ -8,6 +8,9 @@
 
 #include "tile_data.hpp"
 #include "grid2d.hpp"
+#include "bitboard.hpp"
+#include "chunked_map.hpp"
+#include "spatial_hash.hpp"
 
 namespace tez {
 
@@ -33,6 +36,88 @@ public:
     room(index_t w, index_t h, tile_data value = tile_data{});
 };
 
+//==============================================================================
+//! The tiles of many rooms stored contiguously in a single buffer.
+//!
+//! Rooms are appended and only removed from the back. After reserve(), a
+//! whole layout is built with at most a few allocations; when reused after
+//! clear(), usually with none.
+//==============================================================================
+class room_store {
+public:
+    using view_type       = grid_view<tile_data>;
+    using const_view_type = const_grid_view<tile_data>;
+
+    //No implicit copies
+    room_store(room_store const&) = delete;
+    room_store& operator=(room_store const&) = delete;
+
+    //Move operators
+    room_store(room_store&& other);
+    room_store& operator=(room_store&& rhs);
+    void swap(room_store& other);
+
+    room_store() : capacity_ {0}, used_ {0} {}
+
+    //! Reserve space for @c rooms rooms of @c tiles tiles in total. The tile
+    //! storage is left uninitialized but is still allocated, so reserve for
+    //! the expected total rather than the worst case; the store grows past it
+    //! as needed.
+    void reserve(size_t rooms, size_t tiles);
+
+    //! Append a room of w x h tiles set to @c value.
+    //! @returns The tiles of the new room; valid until the next append.
+    view_type add(size_t w, size_t h, tile_data value = tile_data {});
+
+    //! Append a copy of @c src.
+    //! @pre @c src does not refer to tiles in this store.
+    view_type add(const_view_type src);
+
+    //! Remove the last room.
+    void pop_back();
+
+    //! Remove every room; the storage is kept.
+    void clear();
+
+    size_t size()       const BK_NOEXCEPT { return rooms_.size(); }
+    size_t tile_count() const BK_NOEXCEPT { return used_; }
+    bool   empty()      const BK_NOEXCEPT { return rooms_.empty(); }
+
+    view_type operator[](size_t const i) {
+        BK_ASSERT(i < size());
+        auto const& r = rooms_[i];
+        return view_type {tiles_.get() + r.offset, r.width, r.height, r.width};
+    }
+
+    const_view_type operator[](size_t const i) const {
+        BK_ASSERT(i < size());
+        auto const& r = rooms_[i];
+        return const_view_type {tiles_.get() + r.offset, r.width, r.height, r.width};
+    }
+private:
+    struct entry {
+        size_t offset;
+        size_t width;
+        size_t height;
+    };
+
+    struct free_tiles {
+        void operator()(tile_data* const p) const BK_NOEXCEPT { ::operator delete(p); }
+    };
+
+    //! Reallocate to hold at least @c n tiles.
+    void grow_(size_t n);
+
+    //tiles are written in place and never destroyed.
+    static_assert(std::is_trivially_copyable<tile_data>::value, "");
+    static_assert(std::is_trivially_destructible<tile_data>::value, "");
+
+    std::vector<entry>                     rooms_;
+    std::unique_ptr<tile_data, free_tiles> tiles_;    //!< uninitialized storage.
+    size_t                                 capacity_; //!< of tiles_.
+    size_t                                 used_;     //!< tiles in use.
+};
+
 class map : public grid2d<tile_data> {
     using rect = bklib::axis_aligned_rect<int>;
 
@@ -42,23 +127,26 @@ class map : public grid2d<tile_data> {
 
     map(index_t w, index_t h) : grid2d(w, h) {}
 
+    //! Stamp the non-empty tiles of @c src at @c room_rect.
+    //! @pre The tiles stamped over are empty; as for chunked_map::write.
     void write(room const& src, rect const& room_rect) {
         auto const x = room_rect.left(); BK_ASSERT(x >= 0);
         auto const y = room_rect.top();  BK_ASSERT(y >= 0);
 
-        auto& dest = *this;
-
-        for (auto const& tile : src) {
-            auto const& pos   = tile.i;
-            auto const& value = tile.value;
+        auto const from = src.view();
+        auto const to   = view({static_cast<index_t>(x), static_cast<index_t>(y)}
+          , from.width(), from.height());
 
-            auto const xi = pos.x + x; BK_ASSERT(xi < width());
-            auto const yi = pos.y + y; BK_ASSERT(yi < height());
+        for (size_t yi = 0; yi < from.height(); ++yi) {
+            auto const in  = from.row(yi).data();
+            auto const out = to.row(yi).data();
 
-            auto& t = dest[{xi, yi}];
-            BK_ASSERT(t.type == tile_type::empty);
+            for (size_t xi = 0; xi < from.width(); ++xi) {
+                if (in[xi].type == tile_type::empty) continue;
 
-            t = value;
+                BK_ASSERT(out[xi].type == tile_type::empty);
+                out[xi] = in[xi];
+            }
         }
     }
 };
@@ -76,6 +164,9 @@ struct room_simple_fixed {
 
     room generate(random& rand) const;
 
+    //! Append the room to @c out rather than allocating it.
+    room_store::view_type generate(random& rand, room_store& out) const;
+
     unsigned width_;
     unsigned height_;
 };
@@ -91,10 +182,108 @@ struct room_simple {
 
     room generate(random& rand);
 
+    //! Append the room to @c out rather than allocating it.
+    room_store::view_type generate(random& rand, room_store& out);
+
+    //! @returns The most tiles in a room.
+    size_t max_area() const {
+        return width_.max() * height_.max();
+    }
+
+    //! @returns The mean tiles in a room, rounded up; for room_store::reserve.
+    size_t expected_area() const {
+        return ((width_.min()  + width_.max()  + 1) / 2)
+             * ((height_.min() + height_.max() + 1) / 2);
+    }
+
     distribution width_;
     distribution height_;
 };
 
+//==============================================================================
+//! Generator for irregular cave-like rooms: random noise smoothed by a few
+//! generations of a cellular automaton.
+//==============================================================================
+struct room_cave {
+    //! @param density     The initial fraction of rock.
+    //! @param generations The number of smoothing steps.
+    //! @pre w and h are at least 3; the border alone is 2 tiles.
+    room_cave(
+        unsigned w
+      , unsigned h
+      , float    density     = 0.45f
+      , unsigned generations = 4
+      , ca_rule  rule        = ca_rule::cave()
+    )
+      : width_{w}, height_{h}, density_{density}, generations_{generations}, rule_(rule)
+    {
+        BK_ASSERT(w >= 3 && h >= 3);
+    }
+
+    //! @returns The cave as a board where set bits are rock; the border is
+    //! always rock.
+    bitboard generate_bits(random& rand) const;
+
+    //! @returns A room with floor for open tiles and wall for rock next to
+    //! them; all other tiles are empty.
+    room generate(random& rand) const;
+
+    //! Append the room to @c out rather than allocating it.
+    room_store::view_type generate(random& rand, room_store& out) const;
+
+    unsigned width_;
+    unsigned height_;
+    float    density_;
+    unsigned generations_;
+    ca_rule  rule_;
+};
+
+//==============================================================================
+//! Limits on the work done placing a single room.
+//==============================================================================
+struct placement_budget {
+    //! @param attempts The maximum number of candidate positions; 0 for no limit.
+    //! @param time The maximum time; zero for no limit.
+    explicit placement_budget(
+        uint32_t const attempts = DEFAULT_ATTEMPTS
+      , std::chrono::steady_clock::duration const time = std::chrono::steady_clock::duration::zero()
+    ) BK_NOEXCEPT
+      : max_attempts {attempts}
+      , max_time {time}
+    {
+    }
+
+    static placement_budget unlimited() BK_NOEXCEPT {
+        return placement_budget {0};
+    }
+
+    static uint32_t const DEFAULT_ATTEMPTS = 1000;
+
+    uint32_t                            max_attempts;
+    std::chrono::steady_clock::duration max_time;
+};
+
+//==============================================================================
+//! The work done placing a single room.
+//==============================================================================
+struct placement_stats {
+    uint32_t attempts;    //!< candidate positions tested.
+    uint32_t corrections; //!< candidates which overlapped and were moved.
+    uint32_t rejections;  //!< corrected candidates which still overlapped.
+    bool     placed;
+
+    //! Histogram of one counter over @c stats.
+    //! @returns Bucket i counts the entries with a value in [2^i - 1, 2^(i+1) - 1);
+    //!          i.e. 0, 1-2, 3-6, 7-14, ...
+    static std::vector<size_t> histogram(
+        std::vector<placement_stats> const& stats
+      , uint32_t placement_stats::*         counter
+    );
+
+    //! Write a histogram() as "min,max,count" lines.
+    static void write_histogram(std::ostream& out, std::vector<size_t> const& buckets);
+};
+
 //==============================================================================
 //! Generator for simple rectangular rooms of random size.
 //==============================================================================
@@ -134,8 +323,10 @@ struct layout_random {
     void normalize() {
         auto v = bklib::make_vector2d(range_x_.min, range_y_.min);
 
+        index_.clear();
         for (auto& r : rects_) {
             r -= v;
+            index_.insert(r);
         }
 
         range_x_.max -= range_x_.min;
@@ -145,38 +336,105 @@ struct layout_random {
         range_y_.min = 0;
     }
 
+    //! @returns Whether no two rects intersect.
     bool verify() const {
-        for (auto i = 0u; i < rects_.size(); ++i) {
-            for (auto j = i + 1; j < rects_.size(); ++j) {
-                auto const& a = rects_[i];
-                auto const& b = rects_[j];
-                if (bklib::intersects(a, b)) {
-                    return false;
-                }
-            }
-        }
-
-        return true;
+        return !bklib::any_intersecting_pair(std::begin(rects_), std::end(rects_));
     }
 
     bool intersects(rect const r) const {
-        return std::cend(rects_) != std::find_if(
-            std::cbegin(rects_), std::cend(rects_)
-          , [r](rect const ir) {
-                return bklib::intersects(r, ir);
-            }
-        );
+        return index_.any_intersecting(r);
     }
 
     static int const MAX_ITERATIONS = 10;
     static int const MIN_SEPARATION = 1;
 
-    void insert(random& rand, room&& new_room) {
+    //! Reserve space for @c rooms rooms of @c tiles tiles in total.
+    void reserve(size_t const rooms, size_t const tiles) {
+        rects_.reserve(rooms);
+        stats_.reserve(rooms);
+        data_.reserve(rooms, tiles);
+    }
+
+    //! Insert a copy of @c new_room, trying placements until one succeeds.
+    //! The time taken is unbounded; prefer try_insert.
+    void insert(random& rand, room const& new_room) {
+        auto const ok = try_insert(rand, new_room, placement_budget::unlimited());
+        BK_ASSERT(ok);
+    }
+
+    //! Try to insert a copy of @c new_room within @c budget; the outcome is
+    //! appended to stats_.
+    //! @returns true if the room was placed.
+    bool try_insert(random& rand, room const& new_room, placement_budget const budget = placement_budget {}) {
+        if (!place_(rand, new_room.width(), new_room.height(), budget)) {
+            return false;
+        }
+
+        data_.add(new_room.view());
+        return true;
+    }
+
+    //! As try_insert, but the room is made by gen.generate(rand, data_)
+    //! directly in data_; it is removed again if it can't be placed.
+    template <typename Generator>
+    bool try_generate(random& rand, Generator& gen, placement_budget const budget = placement_budget {}) {
+        auto const v = gen.generate(rand, data_);
+
+        if (!place_(rand, v.width(), v.height(), budget)) {
+            data_.pop_back();
+            return false;
+        }
+
+        return true;
+    }
+
+    grid2d<tile_data> to_grid() const {
+        BK_ASSERT(!rects_.empty());
+        BK_ASSERT(rects_.size() == data_.size());
+
+        auto result = grid2d<tile_data>(range_x_.range(), range_y_.range());
+
+        for (size_t i = 0; i < rects_.size(); ++i) {
+            auto const& rect = rects_[i];
+
+            result.blit(
+                {static_cast<size_t>(rect.left()), static_cast<size_t>(rect.top())}
+              , data_[i]
+            );
+        }
+
+        return result;
+    }
+
+    //! Write every room into @c dest; unlike to_grid() no storage is needed
+    //! for the empty space between rooms.
+    void write_to(chunked_map& dest) const {
+        BK_ASSERT(rects_.size() == data_.size());
+
+        for (size_t i = 0; i < rects_.size(); ++i) {
+            dest.write(data_[i], rects_[i]);
+        }
+    }
+
+    std::vector<rect> rects_;
+    room_store        data_;
+
+    //! One entry per call to try_insert or try_generate.
+    std::vector<placement_stats> stats_;
+
+    //! Index of rects_ for overlap queries.
+    spatial_hash                    index_;
+    std::vector<spatial_hash::id_t> query_;
+private:
+    //! Find a place for a room of size width x height within @c budget and
+    //! append its rect to rects_ and its stats to stats_.
+    bool place_(random& rand, size_t const width, size_t const height, placement_budget const budget) {
         using namespace bklib;
+        using clock = std::chrono::steady_clock;
         static auto const zero = make_vector2d(0.0f, 0.0f);
 
-        auto const w = static_cast<int>(new_room.width());
-        auto const h = static_cast<int>(new_room.height());
+        auto const w = static_cast<int>(width);
+        auto const h = static_cast<int>(height);
         auto const r = magnitude(make_vector2d(w/2.0f, h/2.0f));
 
         auto test_rect = rect{
@@ -188,41 +446,67 @@ struct layout_random {
 
         bool inserted  = rects_.empty();
 
+        placement_stats stats {0, 0, 0, false};
+
+        auto const timed    = budget.max_time != clock::duration::zero();
+        auto const deadline = timed ? clock::now() + budget.max_time : clock::time_point {};
+
+        auto const exhausted = [&] {
+            return (budget.max_attempts && stats.attempts >= budget.max_attempts)
+                || (timed && clock::now() >= deadline);
+        };
+
         //calculate a displacement vector that is the sum of the vectors between
         //the centers of the existing rects which intersect test_rect.
         auto get_correction = [&](rect const& test_rect) {
             auto const c = bounding_circle(test_rect);
-            return accumulate_if(rects_, zero
-                , [&](rect const& r) { return bklib::intersects(r, test_rect); }
-                , [&](vector2d<float> const& v, rect const& ir) {
-                    return v + separation_vector(c, bounding_circle(ir));
-                }
-            );
+
+            index_.query(test_rect, query_);
+
+            auto v = zero;
+            for (auto const id : query_) {
+                v = v + separation_vector(c, bounding_circle(rects_[id]));
+            }
+
+            return std::make_pair(query_.size(), v);
         };
 
         //loop through existing rects with a random starting index.
-        for (auto i = looped_index {rand, rects_.size()}; !inserted; ++i) {
+        for (auto i = looped_index {rand, rects_.size()}; !inserted && !exhausted(); ++i) {
             auto const cur_rect   = rects_[i];
             auto const cur_circle = bounding_circle(cur_rect);
             
             //try to place the new room at a location randomly rotated around
             //cur_rect.
-            for (auto n = 0; !inserted && n < MAX_ITERATIONS; ++n) {
+            for (auto n = 0; !inserted && n < MAX_ITERATIONS && !exhausted(); ++n) {
                 auto const v = random_direction(rand) * (r + cur_circle.r);
                 auto const p = round_toward<int>(cur_circle.p + v, v);
 
                 test_rect =  rect(rect::center_point(p), w + 2*MIN_SEPARATION, h + 2*MIN_SEPARATION);
 
+                ++stats.attempts;
+
                 auto const correction = get_correction(test_rect);
                 inserted = (correction.first == 0);
 
                 if (!inserted) {
+                    ++stats.corrections;
+
                     test_rect += round_toward<int>(correction.second);
                     inserted  =  !intersects(test_rect);
+
+                    if (!inserted) ++stats.rejections;
                 }
             }
         }
 
+        stats.placed = inserted;
+        stats_.push_back(stats);
+
+        if (!inserted) {
+            return false;
+        }
+
         test_rect = rect{
             test_rect.left()   + MIN_SEPARATION
           , test_rect.top()    + MIN_SEPARATION
@@ -232,33 +516,70 @@ struct layout_random {
 
         update_ranges(test_rect);
         rects_.emplace_back(test_rect);
-        data_.emplace_back(std::move(new_room));
+        index_.insert(test_rect);
+
+        return true;
     }
+};
 
-    grid2d<tile_data> to_grid() const {
-        BK_ASSERT(!rects_.empty());
-        BK_ASSERT(rects_.size() == data_.size());
+//==============================================================================
+//! Generator for layouts made by binary space partitioning.
+//!
+//! The area is split recursively, across its longer side, until the parts are
+//! too small to split again; each leaf gets one room placed inside it. Every
+//! step draws a fixed number of random values, so the run time is O(n) in the
+//! number of rooms with no rejection. Rooms in sibling subtrees are
+//! neighbours; links() uses the tree to connect every room.
+//==============================================================================
+struct layout_bsp {
+    using rect = bklib::axis_aligned_rect<int>;
+    using link = std::pair<size_t, size_t>;
 
-        auto result = grid2d<tile_data>(range_x_.range(), range_y_.range());
+    struct node {
+        rect    area;
+        int32_t child[2]; //!< -1 for leaves.
+        int32_t room;     //!< index into rects_ for leaves, otherwise -1.
+        bool    split_x;  //!< split with a vertical line.
+    };
 
-        for (size_t i = 0; i < rects_.size(); ++i) {
-            auto const& rect = rects_[i];
-            auto const& room = data_[i];
+    //! @param min_leaf The smallest width or height of a leaf; rooms are
+    //!        at most the leaf size less a one tile margin.
+    //! @pre The area is at least one leaf in each direction.
+    layout_bsp(int width, int height, int min_leaf = 12)
+      : width_{width}, height_{height}, min_leaf_{min_leaf}
+    {
+        BK_ASSERT(min_leaf >= 5);
+        BK_ASSERT(width >= min_leaf && height >= min_leaf);
+    }
 
-            for (auto const& tile_info : room) {
-                auto pos = tile_info.i;
-                pos.x += rect.left();
-                pos.y += rect.top();
+    //! Partition the area and create a room for each leaf with @c gen.
+    void generate(random& rand, room_simple& gen);
 
-                result[pos] = tile_info.value;
-            }
+    //! @returns One link per internal node between the rooms on either side
+    //! of its split that lie closest to it; a spanning tree over the rooms.
+    std::vector<link> links() const;
+
+    grid2d<tile_data> to_grid() const {
+        auto result = grid2d<tile_data>(width_, height_);
+
+        for (size_t i = 0; i < rects_.size(); ++i) {
+            auto const& r = rects_[i];
+            result.blit({static_cast<size_t>(r.left()), static_cast<size_t>(r.top())}, data_[i]);
         }
 
         return result;
     }
 
+    int width_;
+    int height_;
+    int min_leaf_;
+
+    std::vector<node> nodes_;
     std::vector<rect> rects_;
-    std::vector<room> data_;
+    room_store        data_;
+private:
+    //! The room in subtree @c n nearest the low (high) side of its area.
+    size_t nearest_room_(int32_t n, bool split_x, bool high) const;
 };
 //==============================================================================
 } //namespace genertor
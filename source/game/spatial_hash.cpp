@@ -0,0 +1,110 @@
+#include "pch.hpp"
+
+#include "spatial_hash.hpp"
+
+using spatial_hash = tez::spatial_hash;
+
+//==============================================================================
+spatial_hash::spatial_hash(int const cell_size)
+  : cell_size_{cell_size}
+{
+    BK_ASSERT(cell_size > 0);
+}
+
+spatial_hash::spatial_hash(spatial_hash&& other)
+  : cell_size_{other.cell_size_}
+  , rects_(std::move(other.rects_))
+  , cells_(std::move(other.cells_))
+{
+}
+
+spatial_hash& spatial_hash::operator=(spatial_hash&& rhs) {
+    rhs.swap(*this);
+    return *this;
+}
+
+void spatial_hash::swap(spatial_hash& other) {
+    using std::swap;
+    swap(cell_size_, other.cell_size_);
+    swap(rects_,     other.rects_);
+    swap(cells_,     other.cells_);
+}
+
+//==============================================================================
+spatial_hash::cell_range spatial_hash::cells_of_(rect const r) const BK_NOEXCEPT {
+    auto const n = cell_size_;
+    //round toward negative infinity.
+    auto const div = [n](int const v) { return (v >= 0) ? v / n : -((-v + n - 1) / n); };
+
+    //right and bottom are exclusive.
+    return {
+        div(r.left())
+      , div(r.top())
+      , div(std::max(r.left(), r.right()  - 1))
+      , div(std::max(r.top(),  r.bottom() - 1))
+    };
+}
+
+spatial_hash::id_t spatial_hash::insert(rect const r) {
+    auto const id = static_cast<id_t>(rects_.size());
+    rects_.push_back(r);
+
+    auto const c = cells_of_(r);
+    for (auto y = c.y0; y <= c.y1; ++y) {
+        for (auto x = c.x0; x <= c.x1; ++x) {
+            cells_[key_(x, y)].push_back(id);
+        }
+    }
+
+    return id;
+}
+
+void spatial_hash::clear() {
+    rects_.clear();
+    cells_.clear();
+}
+
+//==============================================================================
+void spatial_hash::query(rect const r, std::vector<id_t>& out) const {
+    out.clear();
+
+    auto const q = cells_of_(r);
+
+    for (auto y = q.y0; y <= q.y1; ++y) {
+        for (auto x = q.x0; x <= q.x1; ++x) {
+            auto const it = cells_.find(key_(x, y));
+            if (it == std::end(cells_)) continue;
+
+            for (auto const id : it->second) {
+                auto const& candidate = rects_[id];
+                if (!bklib::intersects(r, candidate)) continue;
+
+                //a rect spanning several cells is reported only from the
+                //first cell shared with the query.
+                auto const c = cells_of_(candidate);
+                if (x != std::max(q.x0, c.x0) || y != std::max(q.y0, c.y0)) continue;
+
+                out.push_back(id);
+            }
+        }
+    }
+
+    std::sort(std::begin(out), std::end(out));
+}
+
+bool spatial_hash::any_intersecting(rect const r) const {
+    auto const q = cells_of_(r);
+
+    for (auto y = q.y0; y <= q.y1; ++y) {
+        for (auto x = q.x0; x <= q.x1; ++x) {
+            auto const it = cells_.find(key_(x, y));
+            if (it == std::end(cells_)) continue;
+
+            for (auto const id : it->second) {
+                if (bklib::intersects(r, rects_[id])) return true;
+            }
+        }
+    }
+
+    return false;
+}
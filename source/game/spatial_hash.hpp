@@ -0,0 +1,72 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "config.hpp"
+#include "assert.hpp"
+#include "math.hpp"
+
+namespace tez {
+
+//==============================================================================
+//! A uniform grid of square cells indexing a growing set of rects.
+//!
+//! Each rect is recorded in every cell it overlaps; a query only examines the
+//! cells overlapped by the query rect. Only occupied cells use any storage so
+//! coordinates are unbounded. Rects are identified by their insertion order.
+//==============================================================================
+class spatial_hash {
+public:
+    using rect = bklib::axis_aligned_rect<int>;
+    using id_t = uint32_t;
+
+    //! @param cell_size Cell dimension; about the size of a typical rect.
+    explicit spatial_hash(int cell_size = 16);
+
+    spatial_hash(spatial_hash&& other);
+    spatial_hash& operator=(spatial_hash&& rhs);
+    void swap(spatial_hash& other);
+
+    //No implicit copies
+    spatial_hash(spatial_hash const&) = delete;
+    spatial_hash& operator=(spatial_hash const&) = delete;
+
+    //! @returns The id of @c r.
+    id_t insert(rect r);
+
+    //! Remove every rect; the cell size is unchanged.
+    void clear();
+
+    size_t size() const BK_NOEXCEPT { return rects_.size(); }
+
+    rect const& operator[](id_t const id) const BK_NOEXCEPT {
+        BK_ASSERT(id < rects_.size());
+        return rects_[id];
+    }
+
+    //! Replace the contents of @c out with the ids of the rects intersecting
+    //! @c r in ascending order.
+    void query(rect r, std::vector<id_t>& out) const;
+
+    //! @returns Whether any rect intersects @c r.
+    bool any_intersecting(rect r) const;
+private:
+    struct cell_range {
+        int x0, y0, x1, y1; //inclusive
+    };
+
+    cell_range cells_of_(rect r) const BK_NOEXCEPT;
+
+    static uint64_t key_(int const x, int const y) BK_NOEXCEPT {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32)
+             | static_cast<uint64_t>(static_cast<uint32_t>(y));
+    }
+
+    int cell_size_;
+
+    std::vector<rect>                                 rects_;
+    std::unordered_map<uint64_t, std::vector<id_t>>   cells_;
+};
+
+} //namespace tez
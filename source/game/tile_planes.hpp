@@ -0,0 +1,227 @@
+#pragma once
+
+#include <vector>
+
+#include "config.hpp"
+#include "assert.hpp"
+
+#include "tile_data.hpp"
+#include "grid2d.hpp"
+
+namespace tez {
+
+namespace detail {
+    //==========================================================================
+    //! Proxy for a single tile stored in a tile_planes; behaves like a
+    //! tile_data whose members are references into each plane.
+    //==========================================================================
+    template <bool Const>
+    struct tile_planes_ref {
+        template <typename T>
+        using ref_t = typename std::conditional<Const, T const&, T&>::type;
+
+        using offset_t = tile_data::offset_t;
+
+        tile_planes_ref(
+            ref_t<uint64_t>  data
+          , ref_t<offset_t>  offset
+          , ref_t<uint16_t>  sub_type
+          , ref_t<tile_type> type
+          , ref_t<uint8_t>   variation
+        ) BK_NOEXCEPT
+          : data{data}
+          , offset{offset}
+          , sub_type{sub_type}
+          , type{type}
+          , variation{variation}
+        {
+        }
+
+        //! Allow tile_planes_ref<false> -> tile_planes_ref<true>.
+        tile_planes_ref(tile_planes_ref<false> const& other) BK_NOEXCEPT
+          : tile_planes_ref(
+                other.data, other.offset, other.sub_type, other.type, other.variation
+            )
+        {
+        }
+
+        operator tile_data() const {
+            tile_data result {type};
+            result.data      = data;
+            result.offset    = offset;
+            result.sub_type  = sub_type;
+            result.variation = variation;
+            return result;
+        }
+
+        tile_planes_ref const& operator=(tile_data const& rhs) const {
+            static_assert(!Const, "can't assign through a const reference.");
+
+            data      = rhs.data;
+            offset    = rhs.offset;
+            sub_type  = rhs.sub_type;
+            type      = rhs.type;
+            variation = rhs.variation;
+
+            return *this;
+        }
+
+        ref_t<uint64_t>  data;
+        ref_t<offset_t>  offset;
+        ref_t<uint16_t>  sub_type;
+        ref_t<tile_type> type;
+        ref_t<uint8_t>   variation;
+    };
+} //namespace detail
+
+//==============================================================================
+//! Structure of arrays storage for a map of tile_data.
+//!
+//! Each member of tile_data is kept in its own contiguous row-major plane;
+//! all planes share one index space. Queries that only read one member (e.g.
+//! the tile type) stream through that plane alone: 1 byte per tile rather
+//! than 16.
+//==============================================================================
+class tile_planes {
+public:
+    using index_t  = size_t;
+    using index    = index2d<index_t>;
+    using offset_t = tile_data::offset_t;
+
+    using reference       = detail::tile_planes_ref<false>;
+    using const_reference = detail::tile_planes_ref<true>;
+
+    template <typename T> using plane       = grid_view<T>;
+    template <typename T> using const_plane = grid_view<T const>;
+
+    //No implicit copies
+    tile_planes(tile_planes const&) = delete;
+    tile_planes& operator=(tile_planes const&) = delete;
+
+    tile_planes(tile_planes&& other)
+      : width_{other.width_}
+      , height_{other.height_}
+      , data_(std::move(other.data_))
+      , offset_(std::move(other.offset_))
+      , sub_type_(std::move(other.sub_type_))
+      , type_(std::move(other.type_))
+      , variation_(std::move(other.variation_))
+    {
+    }
+
+    tile_planes& operator=(tile_planes&& rhs) {
+        rhs.swap(*this);
+        return *this;
+    }
+
+    void swap(tile_planes& other) {
+        using std::swap;
+        swap(width_,     other.width_);
+        swap(height_,    other.height_);
+        swap(data_,      other.data_);
+        swap(offset_,    other.offset_);
+        swap(sub_type_,  other.sub_type_);
+        swap(type_,      other.type_);
+        swap(variation_, other.variation_);
+    }
+
+    tile_planes(index_t const w, index_t const h, tile_data const value = tile_data {})
+      : width_{w}
+      , height_{h}
+      , data_(w*h, value.data)
+      , offset_(w*h, value.offset)
+      , sub_type_(w*h, value.sub_type)
+      , type_(w*h, value.type)
+      , variation_(w*h, value.variation)
+    {
+    }
+
+    //! Split an array of structures grid into planes.
+    template <typename Layout>
+    explicit tile_planes(grid2d<tile_data, Layout> const& src)
+      : tile_planes(src.width(), src.height())
+    {
+        for (auto const& tile : src) {
+            (*this)[tile.i] = tile.value;
+        }
+    }
+
+    size_t width()  const BK_NOEXCEPT { return width_; }
+    size_t height() const BK_NOEXCEPT { return height_; }
+    size_t size()   const BK_NOEXCEPT { return width() * height(); }
+
+    size_t mem_size() const BK_NOEXCEPT {
+        return sizeof(tile_planes) + size() * (
+            sizeof(uint64_t) + sizeof(offset_t) + sizeof(uint16_t)
+          + sizeof(tile_type) + sizeof(uint8_t)
+        );
+    }
+
+    bool is_valid(index i) const BK_NOEXCEPT {
+        return (i.x < width_) && (i.y < height_);
+    }
+
+    reference operator[](index i) {
+        auto const n = to_index_(i);
+        return reference {data_[n], offset_[n], sub_type_[n], type_[n], variation_[n]};
+    }
+
+    const_reference operator[](index i) const {
+        auto const n = to_index_(i);
+        return const_reference {data_[n], offset_[n], sub_type_[n], type_[n], variation_[n]};
+    }
+
+    //--------------------------------------------------------------------------
+    //! Individual planes.
+    //--------------------------------------------------------------------------
+    plane<uint64_t>  data()       { return plane_(data_); }
+    plane<offset_t>  offsets()    { return plane_(offset_); }
+    plane<uint16_t>  sub_types()  { return plane_(sub_type_); }
+    plane<tile_type> types()      { return plane_(type_); }
+    plane<uint8_t>   variations() { return plane_(variation_); }
+
+    const_plane<uint64_t>  data()       const { return plane_(data_); }
+    const_plane<offset_t>  offsets()    const { return plane_(offset_); }
+    const_plane<uint16_t>  sub_types()  const { return plane_(sub_type_); }
+    const_plane<tile_type> types()      const { return plane_(type_); }
+    const_plane<uint8_t>   variations() const { return plane_(variation_); }
+
+    //! Recombine the planes into an array of structures grid.
+    grid2d<tile_data> to_grid() const {
+        auto result = grid2d<tile_data>(width_, height_);
+
+        for (auto const row : result.rows()) {
+            for (size_t x = 0; x < row.values.size(); ++x) {
+                row.values[x] = (*this)[{x, row.y}];
+            }
+        }
+
+        return result;
+    }
+private:
+    size_t to_index_(index i) const BK_NOEXCEPT {
+        BK_ASSERT(is_valid(i));
+        return i.y * width_ + i.x;
+    }
+
+    template <typename T>
+    plane<T> plane_(std::vector<T>& v) {
+        return plane<T> {v.data(), width_, height_, width_};
+    }
+
+    template <typename T>
+    const_plane<T> plane_(std::vector<T> const& v) const {
+        return const_plane<T> {v.data(), width_, height_, width_};
+    }
+
+    index_t width_;
+    index_t height_;
+
+    std::vector<uint64_t>  data_;
+    std::vector<offset_t>  offset_;
+    std::vector<uint16_t>  sub_type_;
+    std::vector<tile_type> type_;
+    std::vector<uint8_t>   variation_;
+};
+
+} //namespace tez
@@ -0,0 +1,508 @@
+#include "pch.hpp"
+
+#include "wfc.hpp"
+
+#include <cmath>
+
+using wfc         = tez::generator::wfc;
+using pattern_set = wfc::pattern_set;
+using word_t      = pattern_set::word_t;
+
+namespace {
+//==============================================================================
+//! Portable population count.
+//==============================================================================
+size_t popcount(word_t x) BK_NOEXCEPT {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<size_t>((x * 0x0101010101010101ULL) >> 56);
+}
+
+//! x and y offsets of the neighbours in the order used by wfc::compatible.
+int const DX[4] = {-1, 1,  0, 0};
+int const DY[4] = { 0, 0, -1, 1};
+
+size_t const NONE = static_cast<size_t>(-1);
+
+} //namespace
+
+//==============================================================================
+pattern_set pattern_set::first_n(size_t const n) BK_NOEXCEPT {
+    BK_ASSERT(n <= MAX_PATTERNS);
+
+    pattern_set result;
+    for (size_t i = 0; i < WORDS; ++i) {
+        auto const lo = i * 64;
+        if (n >= lo + 64) {
+            result.words[i] = ~word_t {0};
+        } else if (n > lo) {
+            result.words[i] = (word_t {1} << (n - lo)) - 1;
+        }
+    }
+
+    return result;
+}
+
+size_t pattern_set::count() const BK_NOEXCEPT {
+    size_t result = 0;
+    for (auto const w : words) result += popcount(w);
+    return result;
+}
+
+uint8_t const pattern_set::DEBRUIJN_INDEX[64] = {
+     0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4
+  , 62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5
+  , 63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11
+  , 46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+};
+
+//==============================================================================
+wfc::wfc(grid2d<tile_data> const& sample, unsigned const n, bool const periodic)
+  : n_ {n}
+{
+    BK_ASSERT(n > 0);
+    BK_ASSERT(sample.width() >= n && sample.height() >= n);
+
+    auto const same = [](tile_data const& a, tile_data const& b) {
+        return std::memcmp(&a, &b, sizeof(tile_data)) == 0;
+    };
+
+    //palette index of every sample tile.
+    auto indexed = grid2d<uint8_t>(sample.width(), sample.height());
+    for (auto const& i : sample) {
+        auto const it = std::find_if(std::begin(palette_), std::end(palette_)
+          , [&](tile_data const& t) { return same(t, i.value); });
+
+        if (it != std::end(palette_)) {
+            indexed[i.i] = static_cast<uint8_t>(it - std::begin(palette_));
+            continue;
+        }
+
+        if (palette_.size() == 256) {
+            BOOST_THROW_EXCEPTION(too_many_patterns {});
+        }
+
+        indexed[i.i] = static_cast<uint8_t>(palette_.size());
+        palette_.push_back(i.value);
+    }
+
+    //every window of the sample.
+    auto const w = sample.width();
+    auto const h = sample.height();
+    auto const last_x = periodic ? w : w - n + 1;
+    auto const last_y = periodic ? h : h - n + 1;
+
+    std::map<std::vector<uint8_t>, size_t> ids;
+    std::vector<uint8_t> window(n * n);
+
+    for (size_t y = 0; y < last_y; ++y) {
+        for (size_t x = 0; x < last_x; ++x) {
+            for (size_t j = 0; j < n; ++j) {
+                for (size_t i = 0; i < n; ++i) {
+                    window[j * n + i] = indexed[{(x + i) % w, (y + j) % h}];
+                }
+            }
+
+            auto const it = ids.find(window);
+            if (it != std::end(ids)) {
+                weights_[it->second] += 1.0;
+                continue;
+            }
+
+            if (weights_.size() == MAX_PATTERNS) {
+                BOOST_THROW_EXCEPTION(too_many_patterns {});
+            }
+
+            ids.emplace(window, weights_.size());
+            patterns_.insert(std::end(patterns_), std::begin(window), std::end(window));
+            weights_.push_back(1.0);
+        }
+    }
+
+    //q may lie at offset d from p if they agree where they overlap.
+    auto const count = pattern_count();
+    auto const agree = [&](size_t const p, size_t const q, int const dx, int const dy) {
+        auto const a = &patterns_[p * n * n];
+        auto const b = &patterns_[q * n * n];
+        auto const m = static_cast<int>(n);
+
+        for (int y = std::max(0, dy); y < std::min(m, m + dy); ++y) {
+            for (int x = std::max(0, dx); x < std::min(m, m + dx); ++x) {
+                if (a[y * m + x] != b[(y - dy) * m + (x - dx)]) return false;
+            }
+        }
+
+        return true;
+    };
+
+    propagator_.resize(4 * count);
+    for (size_t d = 0; d < 4; ++d) {
+        for (size_t p = 0; p < count; ++p) {
+            for (size_t q = 0; q < count; ++q) {
+                if (agree(p, q, DX[d], DY[d])) propagator_[d * count + p].set(q);
+            }
+        }
+    }
+
+    //the union of the rows for every value of each byte of a domain; built
+    //from the value with its lowest bit cleared. The four directions of each
+    //value are adjacent.
+    auto const bytes = (count + 7) / 8;
+    unions_.resize(bytes * 256 * 4);
+
+    for (size_t b = 0; b < bytes; ++b) {
+        auto const table = &unions_[b * 256 * 4];
+        for (size_t v = 1; v < 256; ++v) {
+            auto const p = b * 8 + pattern_set::lowest_bit(v);
+            for (size_t d = 0; d < 4; ++d) {
+                table[v * 4 + d] = table[(v & (v - 1)) * 4 + d];
+                if (p < count) table[v * 4 + d] |= propagator_[d * count + p];
+            }
+        }
+    }
+}
+
+void wfc::allowed_(pattern_set const& domain, pattern_set (&out)[4]) const BK_NOEXCEPT {
+    auto const bytes = (pattern_count() + 7) / 8;
+
+    for (auto& o : out) o = pattern_set {};
+
+    for (size_t b = 0; b < bytes; ++b) {
+        auto const v = (domain.words[b / 8] >> (b % 8 * 8)) & 0xFF;
+        if (!v) continue;
+
+        auto const sets = &unions_[(b * 256 + v) * 4];
+        for (size_t d = 0; d < 4; ++d) out[d] |= sets[d];
+    }
+}
+
+//==============================================================================
+//! The state of a single run.
+//==============================================================================
+class wfc::solver {
+public:
+    solver(wfc const& model, size_t const w, size_t const h)
+      : model_ (model)
+      , width_ {w}
+      , height_ {h}
+      , wave_ (w * h)
+      , sum_w_ (w * h)
+      , sum_wlogw_ (w * h)
+      , key_ (w * h)
+      , noise_ (w * h)
+      , order_ (w * h)
+      , next_ {0}
+      , slot_ (w * h)
+      , queued_ (w * h)
+      , head_ {0}
+    {
+        auto const n = model.pattern_count();
+
+        all_ = pattern_set::first_n(n);
+
+        total_w_     = 0.0;
+        total_wlogw_ = 0.0;
+        wlogw_.resize(n);
+
+        for (size_t p = 0; p < n; ++p) {
+            auto const w = model.weights_[p];
+            wlogw_[p] = w * std::log(w);
+            total_w_     += w;
+            total_wlogw_ += wlogw_[p];
+        }
+
+        full_entropy_ = std::log(total_w_) - total_wlogw_ / total_w_;
+    }
+
+    //! @returns false on a contradiction.
+    bool run(random& rand) {
+        reset_(rand);
+
+        for (;;) {
+            auto const cell = next_cell_();
+            if (cell == NONE) return true;
+
+            collapse_(cell, rand);
+            if (!propagate_()) return false;
+        }
+    }
+
+    //! Write the collapsed wave to @c out.
+    void write(grid2d<tile_data>& out) const {
+        for (auto const row : out.rows()) {
+            auto const wy = std::min(row.y, height_ - 1);
+            auto const ty = static_cast<unsigned>(row.y - wy);
+
+            for (size_t x = 0; x < row.values.size(); ++x) {
+                auto const wx = std::min(x, width_ - 1);
+                auto const tx = static_cast<unsigned>(x - wx);
+
+                auto const& cell = wave_[wy * width_ + wx];
+                BK_ASSERT(cell.count() == 1);
+
+                size_t p = 0;
+                cell.for_each([&](size_t const i) { p = i; });
+
+                row.values[x] = model_.tile(p, tx, ty);
+            }
+        }
+    }
+private:
+    void reset_(random& rand) {
+        std::fill(std::begin(wave_), std::end(wave_), all_);
+        std::fill(std::begin(sum_w_), std::end(sum_w_), total_w_);
+        std::fill(std::begin(sum_wlogw_), std::end(sum_wlogw_), total_wlogw_);
+        std::fill(std::begin(queued_), std::end(queued_), 0);
+
+        //the noise of each cell is its position in a random order.
+        for (size_t i = 0; i < order_.size(); ++i) order_[i] = i;
+        std::shuffle(std::begin(order_), std::end(order_), rand);
+
+        auto const step = 1.0e-6 / static_cast<double>(order_.size());
+        for (size_t i = 0; i < order_.size(); ++i) {
+            noise_[order_[i]] = static_cast<double>(i) * step;
+        }
+
+        next_ = 0;
+
+        queue_.clear();
+        head_ = 0;
+
+        heap_.clear();
+        std::fill(std::begin(slot_), std::end(slot_), NONE);
+    }
+
+    double entropy_(size_t const cell) const {
+        auto const s = sum_w_[cell];
+        return std::log(s) - sum_wlogw_[cell] / s;
+    }
+
+    //==========================================================================
+    // A binary min heap of changed cells by key_ which knows the slot of each
+    // cell; keys are updated in place.
+    //==========================================================================
+    bool less_(size_t const i, size_t const j) const BK_NOEXCEPT {
+        return key_[heap_[i]] < key_[heap_[j]];
+    }
+
+    void swap_(size_t const i, size_t const j) BK_NOEXCEPT {
+        std::swap(heap_[i], heap_[j]);
+        slot_[heap_[i]] = i;
+        slot_[heap_[j]] = j;
+    }
+
+    void sift_up_(size_t i) BK_NOEXCEPT {
+        while (i > 0) {
+            auto const parent = (i - 1) / 2;
+            if (!less_(i, parent)) break;
+            swap_(i, parent);
+            i = parent;
+        }
+    }
+
+    void sift_down_(size_t i) BK_NOEXCEPT {
+        auto const n = heap_.size();
+
+        for (;;) {
+            auto const l = 2 * i + 1;
+            auto const r = l + 1;
+
+            auto least = i;
+            if (l < n && less_(l, least)) least = l;
+            if (r < n && less_(r, least)) least = r;
+            if (least == i) break;
+
+            swap_(i, least);
+            i = least;
+        }
+    }
+
+    //! Insert @c cell or move it to match its new entropy.
+    void heap_update_(size_t const cell) {
+        key_[cell] = entropy_(cell) + noise_[cell];
+
+        auto i = slot_[cell];
+        if (i == NONE) {
+            i = heap_.size();
+            heap_.push_back(cell);
+            slot_[cell] = i;
+        }
+
+        sift_up_(i);
+        sift_down_(slot_[cell]);
+    }
+
+    void heap_remove_(size_t const cell) BK_NOEXCEPT {
+        auto const i = slot_[cell];
+        if (i == NONE) return;
+
+        auto const last = heap_.size() - 1;
+        if (i != last) swap_(i, last);
+
+        heap_.pop_back();
+        slot_[cell] = NONE;
+
+        if (i != last) {
+            auto const moved = heap_[i];
+            sift_up_(i);
+            sift_down_(slot_[moved]);
+        }
+    }
+
+    //! @returns The uncollapsed cell of least entropy or NONE.
+    //!
+    //! Cells which have never changed share the same entropy and are taken in
+    //! noise order from order_; only cells which have changed are in the heap.
+    size_t next_cell_() {
+        while (next_ < order_.size() && wave_[order_[next_]] != all_) {
+            ++next_;
+        }
+
+        auto const untouched = next_ < order_.size();
+
+        if (heap_.empty()) {
+            return untouched ? order_[next_++] : NONE;
+        }
+
+        auto const cell = heap_.front();
+        if (untouched && full_entropy_ + noise_[order_[next_]] < key_[cell]) {
+            return order_[next_++];
+        }
+
+        return cell;
+    }
+
+    void collapse_(size_t const cell, random& rand) {
+        auto& domain = wave_[cell];
+
+        auto r = std::uniform_real_distribution<double> {0.0, sum_w_[cell]}(rand);
+        size_t chosen = NONE;
+
+        domain.for_each([&](size_t const p) {
+            if (chosen != NONE) return;
+
+            r -= model_.weights_[p];
+            if (r <= 0.0) chosen = p;
+        });
+
+        //rounding; take the last pattern.
+        if (chosen == NONE) domain.for_each([&](size_t const p) { chosen = p; });
+
+        pattern_set single;
+        single.set(chosen);
+        set_domain_(cell, single);
+    }
+
+    //! Replace the domain of @c cell with the subset @c domain and queue it.
+    void set_domain_(size_t const cell, pattern_set const& domain) {
+        auto removed = wave_[cell];
+        for (size_t i = 0; i < pattern_set::WORDS; ++i) {
+            removed.words[i] &= ~domain.words[i];
+        }
+
+        removed.for_each([&](size_t const p) {
+            sum_w_[cell]     -= model_.weights_[p];
+            sum_wlogw_[cell] -= wlogw_[p];
+        });
+
+        wave_[cell] = domain;
+
+        if (!queued_[cell]) {
+            queued_[cell] = 1;
+            queue_.push_back(cell);
+        }
+    }
+
+    //! Remove patterns inconsistent with their neighbours until no more can
+    //! be removed. @returns false on a contradiction.
+    bool propagate_() {
+        while (head_ < queue_.size()) {
+            auto const cell = queue_[head_++];
+            queued_[cell] = 0;
+
+            auto const x = static_cast<int>(cell % width_);
+            auto const y = static_cast<int>(cell / width_);
+
+            pattern_set allowed[4];
+            model_.allowed_(wave_[cell], allowed);
+
+            for (size_t d = 0; d < 4; ++d) {
+                auto const nx = x + DX[d];
+                auto const ny = y + DY[d];
+                if (nx < 0 || ny < 0 || nx >= static_cast<int>(width_) || ny >= static_cast<int>(height_)) {
+                    continue;
+                }
+
+                auto const neighbour = static_cast<size_t>(ny) * width_ + static_cast<size_t>(nx);
+
+                auto domain = wave_[neighbour];
+                domain &= allowed[d];
+
+                if (domain == wave_[neighbour]) continue;
+                if (domain.none()) return false;
+
+                set_domain_(neighbour, domain);
+            }
+        }
+
+        //each changed cell is updated once after it has settled.
+        for (auto const cell : queue_) {
+            if (wave_[cell].single()) {
+                heap_remove_(cell);
+            } else if (!queued_[cell]) {
+                queued_[cell] = 1;
+                heap_update_(cell);
+            }
+        }
+
+        for (auto const cell : queue_) queued_[cell] = 0;
+
+        queue_.clear();
+        head_ = 0;
+
+        return true;
+    }
+
+    wfc const& model_;
+
+    size_t width_;
+    size_t height_;
+
+    pattern_set         all_;
+    double              total_w_;
+    double              total_wlogw_;
+    std::vector<double> wlogw_; //!< w log w of each pattern.
+
+    std::vector<pattern_set> wave_;      //!< the possible patterns of each cell.
+    std::vector<double>      sum_w_;     //!< sum of the weights in wave_.
+    std::vector<double>      sum_wlogw_; //!< sum of w log w in wave_.
+    std::vector<double>      key_;       //!< the current heap key of each cell.
+    std::vector<double>      noise_;     //!< breaks ties between equal entropies.
+
+    std::vector<size_t> order_;        //!< every cell by increasing noise.
+    size_t              next_;         //!< the first of order_ which may be unchanged.
+    double              full_entropy_; //!< the entropy of an unchanged cell.
+
+    std::vector<size_t>  heap_;   //!< changed cells which are not collapsed.
+    std::vector<size_t>  slot_;   //!< the index of each cell in heap_ or NONE.
+    std::vector<size_t>  queue_;  //!< cells whose domain changed.
+    std::vector<uint8_t> queued_; //!< whether each cell is in queue_.
+    size_t               head_;   //!< the front of queue_.
+};
+
+//==============================================================================
+bool wfc::generate(random& rand, grid2d<tile_data>& out, unsigned const attempts) const {
+    BK_ASSERT(out.width() >= n_ && out.height() >= n_);
+
+    auto s = solver {*this, out.width() - n_ + 1, out.height() - n_ + 1};
+
+    for (unsigned i = 0; i < attempts; ++i) {
+        if (s.run(rand)) {
+            s.write(out);
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "config.hpp"
+#include "assert.hpp"
+#include "exception.hpp"
+
+#include "tile_data.hpp"
+#include "grid2d.hpp"
+#include "room.hpp"
+
+namespace tez {
+namespace generator {
+
+//! The sample given to wfc has more distinct patterns than wfc::MAX_PATTERNS.
+struct too_many_patterns : virtual bklib::exception_base {};
+
+//==============================================================================
+//! Wave function collapse (overlapping model).
+//!
+//! Every n x n window of a sample map is a pattern, weighted by how often it
+//! occurs. The output is a grid where every n x n window is one of those
+//! patterns: each cell holds the set of patterns still possible at that
+//! position; the cell of least entropy is repeatedly collapsed to a single
+//! pattern, chosen by weight, and the constraint that neighbouring patterns
+//! overlap consistently is propagated from it until nothing changes.
+//!
+//! Domains are fixed size bitsets; propagation works through a queue of
+//! changed cells and the lowest entropy cell is found with a heap holding only
+//! the cells which have changed. A contradiction restarts the run.
+//==============================================================================
+class wfc {
+public:
+    //! The most patterns a sample may produce.
+    static size_t const MAX_PATTERNS = 256;
+
+    //==========================================================================
+    //! A set of patterns.
+    //==========================================================================
+    struct pattern_set {
+        using word_t = uint64_t;
+        static size_t const WORDS = MAX_PATTERNS / 64;
+
+        pattern_set() BK_NOEXCEPT { words.fill(0); }
+
+        //! The set [0, n).
+        static pattern_set first_n(size_t n) BK_NOEXCEPT;
+
+        void set(size_t const i) BK_NOEXCEPT {
+            words[i / 64] |= word_t {1} << (i % 64);
+        }
+
+        bool test(size_t const i) const BK_NOEXCEPT {
+            return (words[i / 64] >> (i % 64)) & 1;
+        }
+
+        bool none() const BK_NOEXCEPT {
+            word_t any = 0;
+            for (auto const w : words) any |= w;
+            return any == 0;
+        }
+
+        size_t count() const BK_NOEXCEPT;
+
+        //! @returns Whether exactly one element is in the set.
+        bool single() const BK_NOEXCEPT {
+            size_t nonzero = 0;
+            word_t multiple = 0;
+            for (auto const w : words) {
+                nonzero  += w ? 1 : 0;
+                multiple |= w & (w - 1);
+            }
+            return nonzero == 1 && multiple == 0;
+        }
+
+        pattern_set& operator|=(pattern_set const& rhs) BK_NOEXCEPT {
+            for (size_t i = 0; i < WORDS; ++i) words[i] |= rhs.words[i];
+            return *this;
+        }
+
+        pattern_set& operator&=(pattern_set const& rhs) BK_NOEXCEPT {
+            for (size_t i = 0; i < WORDS; ++i) words[i] &= rhs.words[i];
+            return *this;
+        }
+
+        bool operator==(pattern_set const& rhs) const BK_NOEXCEPT {
+            return words == rhs.words;
+        }
+
+        bool operator!=(pattern_set const& rhs) const BK_NOEXCEPT {
+            return !(*this == rhs);
+        }
+
+        //! Call f(i) for each i in the set in ascending order.
+        template <typename F>
+        void for_each(F f) const {
+            for (size_t i = 0; i < WORDS; ++i) {
+                for (auto w = words[i]; w; w &= w - 1) {
+                    f(i * 64 + lowest_bit(w));
+                }
+            }
+        }
+
+        //! @returns The index of the lowest set bit of @c w != 0.
+        static size_t lowest_bit(word_t const w) BK_NOEXCEPT {
+            BK_ASSERT(w != 0);
+            return DEBRUIJN_INDEX[((w & (~w + 1)) * DEBRUIJN) >> 58];
+        }
+
+        static word_t const DEBRUIJN = 0x03F79D71B4CB0A89ULL;
+        static uint8_t const DEBRUIJN_INDEX[64];
+
+        std::array<word_t, WORDS> words;
+    };
+
+    //! @param sample   The example map; every distinct tile_data is a value.
+    //! @param n        The size of a pattern.
+    //! @param periodic Whether windows of the sample wrap around its edges.
+    //! @throws too_many_patterns
+    wfc(grid2d<tile_data> const& sample, unsigned n = 3, bool periodic = true);
+
+    size_t pattern_count() const BK_NOEXCEPT { return weights_.size(); }
+    unsigned pattern_size() const BK_NOEXCEPT { return n_; }
+
+    //! Fill @c out, restarting on a contradiction.
+    //! @pre out is at least pattern_size() in each dimension.
+    //! @returns false if every one of @c attempts ended in a contradiction;
+    //!          @c out is then unspecified.
+    bool generate(random& rand, grid2d<tile_data>& out, unsigned attempts = 10) const;
+
+    //! @returns Tile (x, y) of pattern @c p.
+    tile_data const& tile(size_t p, unsigned x, unsigned y) const {
+        BK_ASSERT(p < pattern_count() && x < n_ && y < n_);
+        return palette_[patterns_[p * n_ * n_ + y * n_ + x]];
+    }
+
+    //! The patterns which may lie next to pattern @c p in direction @c d;
+    //! 0 west, 1 east, 2 north and 3 south.
+    pattern_set const& compatible(size_t const d, size_t const p) const {
+        BK_ASSERT(d < 4 && p < pattern_count());
+        return propagator_[d * pattern_count() + p];
+    }
+private:
+    class solver;
+
+    //! out[d] = the union of compatible(d, p) over every p in @c domain.
+    void allowed_(pattern_set const& domain, pattern_set (&out)[4]) const BK_NOEXCEPT;
+
+    unsigned n_;
+
+    std::vector<tile_data>   palette_;    //!< distinct tiles in the sample.
+    std::vector<uint8_t>     patterns_;   //!< n x n palette indices each.
+    std::vector<double>      weights_;    //!< occurrences of each pattern.
+    std::vector<pattern_set> propagator_; //!< 4 x pattern_count().
+    std::vector<pattern_set> unions_;     //!< byte x 256 x 4; see allowed_().
+};
+
+} //namespace generator
+} //namespace tez
@@ -5,9 +5,12 @@
 
 #include "math.hpp"
 #include "game/room.hpp"
+#include "game/level_pipeline.hpp"
+#include "game/tile_planes.hpp"
 #include "platform/direct2d.hpp"
 
 #include "timekeeper.hpp"
+#include "fixed_timestep.hpp"
 
 #include "game/languages.hpp"
 #include "game/tile_set.hpp"
@@ -609,19 +612,12 @@ try {
     bklib::platform_window win {L"Tez"};
     bklib::win::d2d_renderer renderer {win.get_handle()};
 
-    auto level_map = [&] {
-        auto room_gen = tez::generator::room_simple({3, 10}, {3, 10});
-        tez::generator::layout_random layout;
-        //--------------------------------------------------------------------------    
-        //Temp
-        for (auto i = 0; i < 100; ++i) {
-            layout.insert(rand, room_gen.generate(rand));
-        }
-        layout.normalize();
-        //--------------------------------------------------------------------------
+    //the first level as before; the next ones are built in the background.
+    auto const level_gen = tez::level_generator {};
+    auto level_map = tez::tile_planes {level_gen.generate(rand)};
 
-        return layout.to_grid();
-    }();
+    tez::level_pipeline levels {level_gen, 100};
+    auto want_next = false;
 
     auto tile_image = renderer.load_image();
 
@@ -630,22 +626,25 @@ try {
         renderer.begin();
         renderer.clear();
 
-        for (auto const& tile_info : level_map) {
-            auto const p = tile_info.i;
+        //only the type plane is needed here.
+        for (auto const row : level_map.types().rows()) {
+            for (size_t x = 0; x < row.values.size(); ++x) {
+                auto const type = row.values[x];
 
-            if (tile_info.value.type == tez::tile_type::empty) continue;
+                if (type == tez::tile_type::empty) continue;
 
-            auto const i = static_cast<int>(tile_info.value.type);
+                auto const i = static_cast<int>(type);
 
-            auto src_rect = bklib::axis_aligned_rect<float>(
-                bklib::axis_aligned_rect<float>::tl_point{i*16.f, i*16.f}, 16.f, 16.f
-            );
+                auto src_rect = bklib::axis_aligned_rect<float>(
+                    bklib::axis_aligned_rect<float>::tl_point{i*16.f, i*16.f}, 16.f, 16.f
+                );
 
-            auto dest_rect = bklib::axis_aligned_rect<float>(
-                bklib::axis_aligned_rect<float>::tl_point{p.x*16.f, p.y*16.f}, 16.f, 16.f
-            );
+                auto dest_rect = bklib::axis_aligned_rect<float>(
+                    bklib::axis_aligned_rect<float>::tl_point{x*16.f, row.y*16.f}, 16.f, 16.f
+                );
 
-            renderer.draw_image(*tile_image, dest_rect, src_rect);
+                renderer.draw_image(*tile_image, dest_rect, src_rect);
+            }
         }
 
         renderer.end();
@@ -686,6 +685,10 @@ try {
         if (alt && kb[keys::S].is_down) {
             std::cout << "ALT-S" << std::endl;
         }
+
+        if (key == keys::N) {
+            want_next = true;
+        }
     };
     //--------------------------------------------------------------------------
     auto const on_keyup = [&](bklib::keyboard& kb, bklib::keys key) {
@@ -710,8 +713,26 @@ try {
       , render
     );
 
+    //the game runs in fixed steps, independent of the cost of rendering.
+    bklib::fixed_timestep game_loop {frame_time(1)};
+
+    //switch levels once one is requested and ready; never waits.
+    game_loop.simulation().register_event(
+        frame_time(1)
+      , [&](bklib::timekeeper::delta) {
+            if (!want_next) return;
+
+            tez::level_pipeline::level next {0, 0};
+            if (levels.try_take(next)) {
+                level_map = tez::tile_planes {next};
+                want_next = false;
+            }
+        }
+    );
+
     while (win.is_running()) {
         win.do_events();
+        game_loop.update();
         time_manager.update();
     }
 
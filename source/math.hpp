@@ -823,6 +823,88 @@ auto intersection_of(
 }
 //------------------------------------------------------------------------------
 
+//==============================================================================
+//! Sweep and prune; call f(i, j) with i < j for every pair of intersecting
+//! rects in [first, last), where i and j are offsets from @c first, until f
+//! returns true.
+//!
+//! The rects are sorted by their left edge and each is tested only against
+//! those which start before it ends; O(n log n + k) where k is the number of
+//! pairs overlapping on the x axis, whether or not they intersect. For n rects
+//! packed into a square without overlaps k is still about n^1.5.
+//!
+//! At the scale of a level (~10k rooms; see GeneratorBench.LayoutRandomScaling)
+//! this is about twice as fast as also keeping the rects spanning the sweep
+//! ordered by y, which bounds the tests by the real overlaps but only pays
+//! for its upkeep beyond ~100k rects.
+//!
+//! @returns Whether f stopped the sweep.
+//==============================================================================
+template <typename It, typename F>
+bool for_each_intersecting_pair_until(It const first, It const last, F f) {
+    auto const n = static_cast<size_t>(std::distance(first, last));
+
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+
+    std::sort(std::begin(order), std::end(order), [&](size_t const a, size_t const b) {
+        return first[a].left() < first[b].left();
+    });
+
+    for (size_t i = 0; i < n; ++i) {
+        auto const& a = first[order[i]];
+
+        for (auto j = i + 1; j < n; ++j) {
+            auto const& b = first[order[j]];
+            if (b.left() >= a.right()) break;
+
+            if (intersects(a, b)
+             && f(std::min(order[i], order[j]), std::max(order[i], order[j]))
+            ) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+//==============================================================================
+//! As above, for every pair.
+//==============================================================================
+template <typename It, typename F>
+void for_each_intersecting_pair(It const first, It const last, F f) {
+    for_each_intersecting_pair_until(first, last, [&](size_t const i, size_t const j) {
+        f(i, j);
+        return false;
+    });
+}
+//==============================================================================
+//! @returns Whether any two rects in [first, last) intersect; stops at the
+//! first pair found.
+//==============================================================================
+template <typename It>
+bool any_intersecting_pair(It const first, It const last) {
+    return for_each_intersecting_pair_until(first, last
+      , [](size_t, size_t) { return true; }
+    );
+}
+//==============================================================================
+//! @returns Every pair (i, j) of intersecting rects in @c rects; i < j.
+//! @see for_each_intersecting_pair.
+//==============================================================================
+template <typename T>
+std::vector<std::pair<size_t, size_t>>
+intersecting_pairs(std::vector<axis_aligned_rect<T>> const& rects) {
+    std::vector<std::pair<size_t, size_t>> result;
+
+    for_each_intersecting_pair(std::begin(rects), std::end(rects)
+      , [&](size_t const i, size_t const j) { result.emplace_back(i, j); }
+    );
+
+    return result;
+}
 
 //==============================================================================
 //! Generate a random direction vector.
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <type_traits>
+
+#include "config.hpp"
+#include "assert.hpp"
+
+namespace bklib {
+
+//==============================================================================
+//! Non-owning view of a contiguous sequence of @c T.
+//==============================================================================
+template <typename T>
+class span {
+public:
+    using value_type      = typename std::remove_const<T>::type;
+    using reference       = T&;
+    using pointer         = T*;
+    using iterator        = T*;
+    using const_iterator  = T const*;
+
+    span() BK_NOEXCEPT : data_{nullptr}, size_{0} {}
+
+    span(T* const data, size_t const size) BK_NOEXCEPT
+      : data_{data}, size_{size}
+    {
+    }
+
+    span(T* const first, T* const last) BK_NOEXCEPT
+      : data_{first}, size_{static_cast<size_t>(last - first)}
+    {
+        BK_ASSERT(last >= first);
+    }
+
+    //! Allow span<T> -> span<T const>.
+    template <typename U>
+    span(
+        span<U> const& other
+      , typename std::enable_if<std::is_convertible<U*, T*>::value>::type* = nullptr
+    ) BK_NOEXCEPT
+      : data_{other.data()}, size_{other.size()}
+    {
+    }
+
+    T*     data()  const BK_NOEXCEPT { return data_; }
+    size_t size()  const BK_NOEXCEPT { return size_; }
+    bool   empty() const BK_NOEXCEPT { return size_ == 0; }
+
+    T* begin() const BK_NOEXCEPT { return data_; }
+    T* end()   const BK_NOEXCEPT { return data_ + size_; }
+
+    reference operator[](size_t const i) const BK_NOEXCEPT {
+        BK_ASSERT(i < size_);
+        return data_[i];
+    }
+
+    //! @returns The sub-span [offset, offset + count).
+    span subspan(size_t const offset, size_t const count) const BK_NOEXCEPT {
+        BK_ASSERT(offset + count <= size_);
+        return span {data_ + offset, count};
+    }
+private:
+    T*     data_;
+    size_t size_;
+};
+
+template <typename T>
+span<T> make_span(T* const data, size_t const size) BK_NOEXCEPT {
+    return span<T>(data, size);
+}
+
+} //namespace bklib
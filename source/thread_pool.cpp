@@ -0,0 +1,55 @@
+#include "pch.hpp"
+#include "thread_pool.hpp"
+
+using pool = bklib::thread_pool;
+
+//==============================================================================
+//!
+//==============================================================================
+pool::thread_pool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this] { main_(); });
+    }
+}
+//==============================================================================
+//!
+//==============================================================================
+pool::~thread_pool() {
+    //an empty job tells a worker to exit.
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        queue_.push(invocable {});
+    }
+
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+//==============================================================================
+//!
+//==============================================================================
+void pool::main_() {
+    for (auto job = queue_.pop(); job; job = queue_.pop()) {
+        job();
+    }
+}
+//==============================================================================
+//!
+//==============================================================================
+void pool::wait_all_(std::vector<std::future<void>>& results) {
+    std::exception_ptr error;
+
+    for (auto& r : results) {
+        try {
+            r.get();
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+}
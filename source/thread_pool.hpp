@@ -0,0 +1,68 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "config.hpp"
+#include "types.hpp"
+#include "concurrent_queue.hpp"
+
+namespace bklib {
+
+//==============================================================================
+//! A fixed size pool of worker threads fed from a single queue.
+//!
+//! Jobs must not block waiting on other jobs submitted to the same pool.
+//==============================================================================
+class thread_pool {
+public:
+    //! @param threads The number of workers; 0 means one per hardware thread.
+    explicit thread_pool(size_t threads = 0);
+
+    //! Waits for queued jobs to finish.
+    ~thread_pool();
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    size_t size() const BK_NOEXCEPT { return threads_.size(); }
+
+    //! Queue @c f to run on a worker.
+    //! @returns A future for the result of f(); exceptions are propagated.
+    template <typename F>
+    auto submit(F f) -> std::future<decltype(f())> {
+        using result_t = decltype(f());
+
+        auto task = std::make_shared<std::packaged_task<result_t ()>>(std::move(f));
+        auto result = task->get_future();
+
+        queue_.push(invocable {[task] { (*task)(); }});
+
+        return result;
+    }
+
+    //! Run f(i) for each i in [0, n) on the pool and wait for all of them.
+    //! The first exception thrown by any f(i) is rethrown once all are done.
+    template <typename F>
+    void for_each_index(size_t const n, F f) {
+        std::vector<std::future<void>> results;
+        results.reserve(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            results.emplace_back(submit([f, i] { f(i); }));
+        }
+
+        wait_all_(results);
+    }
+private:
+    static void wait_all_(std::vector<std::future<void>>& results);
+
+    void main_();
+
+    concurrent_queue<invocable> queue_;
+    std::vector<std::thread>    threads_;
+};
+
+} //namespace bklib
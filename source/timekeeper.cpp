@@ -4,66 +4,170 @@
 using tk = bklib::timekeeper;
 
 //==============================================================================
-//! 
+//!
 //==============================================================================
-tk::timekeeper() {
+tk::timekeeper(duration const resolution)
+  : start_ {clock::now()}
+  , now_ {start_}
+  , resolution_ {resolution}
+{
+    BK_ASSERT(resolution.count() > 0);
 }
 //==============================================================================
-//! 
+//!
 //==============================================================================
-tk::handle tk::register_event_(duration period, callback f) {
-    using namespace std::placeholders;
+bklib::timing_wheel::tick_t tk::tick_floor_(time_point const t) const BK_NOEXCEPT {
+    if (t <= start_) return 0;
+    return static_cast<timing_wheel::tick_t>((t - start_).count() / resolution_.count());
+}
+
+bklib::timing_wheel::tick_t tk::tick_ceil_(time_point const t) const BK_NOEXCEPT {
+    if (t <= start_) return 0;
+
+    auto const n = (t - start_).count();
+    auto const r = resolution_.count();
 
+    return static_cast<timing_wheel::tick_t>((n + r - 1) / r);
+}
+//==============================================================================
+//!
+//==============================================================================
+tk::handle tk::register_event_(duration period, callback f) {
     BK_ASSERT(f);
     BK_ASSERT(period.count() > 0);
 
-    auto const now = clock::now();
-    auto const deadline = now + period;
+    auto const deadline = now_ + period;
 
-    auto const index = records_.size();
-    timekeeper::handle const handle = { index };
+    uint32_t index;
+    if (free_.empty()) {
+        index = static_cast<uint32_t>(records_.size());
+        timekeeper::handle const handle = {index, 0};
 
-    records_.emplace_back(record {
-        handle, std::move(f), period, deadline            
-    });
+        records_.emplace_back(record {
+            handle, std::move(f), period, deadline, duration::zero(), false
+        });
+    } else {
+        index = free_.back();
+        free_.pop_back();
+
+        auto& rec = records_[index];
+        rec.callback  = std::move(f);
+        rec.period    = period;
+        rec.deadline  = deadline;
+        rec.remaining = duration::zero();
+        rec.paused    = false;
+    }
 
-    heap_.emplace_back(index);
-    std::push_heap(
-        std::begin(heap_)
-      , std::end(heap_)
-      , std::bind(&tk::heap_predidate_, this, _1, _2)
-    );
+    wheel_.insert(index, tick_ceil_(deadline));
 
-    return handle;
+    return records_[index].handle;
 }
 //==============================================================================
-//! 
+//!
 //==============================================================================
-void tk::update() {
-    using namespace std::placeholders;
+bool tk::contains(handle const h) const BK_NOEXCEPT {
+    return h.id < records_.size() && records_[h.id].handle.generation == h.generation;
+}
 
-    auto const now = clock::now();
-    duration   dt  = std::chrono::seconds(1);
+bool tk::is_paused(handle const h) const BK_NOEXCEPT {
+    return contains(h) && records_[h.id].paused;
+}
+
+tk::record* tk::find_(handle const h) BK_NOEXCEPT {
+    return contains(h) ? &records_[h.id] : nullptr;
+}
+//==============================================================================
+//!
+//==============================================================================
+bool tk::cancel(handle const h) {
+    auto const rec = find_(h);
+    if (!rec) return false;
 
-    while (!heap_.empty() && dt.count() >= 0) {
-        std::pop_heap(
-            std::begin(heap_)
-          , std::end(heap_)
-          , std::bind(&tk::heap_predidate_, this, _1, _2)
-        );
+    wheel_.remove(h.id);
 
-        auto& rec = records_[heap_.back()];
-        dt = now - rec.deadline;
+    rec->callback = nullptr;
+    rec->paused   = false;
+    ++rec->handle.generation;
 
-        if (dt.count() >= 0) {
-            rec.callback(std::chrono::duration_cast<delta>(dt + rec.period));
-            rec.deadline = now + rec.period;
-        }
+    free_.push_back(h.id);
 
-        std::push_heap(
-            std::begin(heap_)
-          , std::end(heap_)
-          , std::bind(&tk::heap_predidate_, this, _1, _2)
-        );
+    return true;
+}
+
+bool tk::pause(handle const h) {
+    auto const rec = find_(h);
+    if (!rec) return false;
+    if (rec->paused) return true;
+
+    wheel_.remove(h.id);
+
+    rec->remaining = std::max(rec->deadline - now_, duration::zero());
+    rec->paused    = true;
+
+    return true;
+}
+
+bool tk::resume(handle const h) {
+    auto const rec = find_(h);
+    if (!rec) return false;
+    if (!rec->paused) return true;
+
+    rec->deadline = now_ + rec->remaining;
+    rec->paused   = false;
+
+    wheel_.insert(h.id, tick_ceil_(rec->deadline));
+
+    return true;
+}
+
+bool tk::set_period_(handle const h, duration const period) {
+    BK_ASSERT(period.count() > 0);
+
+    auto const rec = find_(h);
+    if (!rec) return false;
+
+    rec->period   = period;
+    rec->deadline = now_ + period;
+
+    if (rec->paused) {
+        rec->remaining = period;
+    } else {
+        wheel_.remove(h.id);
+        wheel_.insert(h.id, tick_ceil_(rec->deadline));
     }
+
+    return true;
+}
+//==============================================================================
+//!
+//==============================================================================
+void tk::update() {
+    update(clock::now());
+}
+
+void tk::update(time_point const now) {
+    BK_ASSERT(now >= now_);
+    now_ = now;
+
+    wheel_.advance(tick_floor_(now), [&](timing_wheel::id_t const id) {
+        //records_ is a deque; the reference survives registrations made by
+        //the callback.
+        auto& rec = records_[id];
+
+        auto const generation = rec.handle.generation;
+        auto const dt = std::chrono::duration_cast<delta>(now - rec.deadline + rec.period);
+
+        //rescheduled first so that the callback can cancel, pause or
+        //reschedule its own event.
+        rec.deadline = now + rec.period;
+        wheel_.insert(id, tick_ceil_(rec.deadline));
+
+        //moved out so that cancelling doesn't destroy it while it runs.
+        auto f = std::move(rec.callback);
+        f(dt);
+
+        if (rec.handle.generation == generation) {
+            rec.callback = std::move(f);
+        }
+    });
 }
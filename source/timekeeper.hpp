@@ -1,33 +1,54 @@
 #pragma once
 
 #include <chrono>
-#include <vector>
+#include <deque>
 #include <functional>
+#include <vector>
 
 #include "config.hpp"
+#include "timing_wheel.hpp"
 
 namespace bklib {
 
+//==============================================================================
+//! Periodic callbacks driven by update().
+//!
+//! Deadlines are kept on a timing_wheel in whole ticks of a fixed resolution;
+//! a deadline is rounded up to the next tick, so an event never fires early
+//! and fires at most one tick late. Registering, firing, rescheduling and
+//! cancelling an event are O(1).
+//!
+//! Handles carry a generation which is bumped whenever an event is cancelled;
+//! its slot is then reused by the next registration and the old handle, being
+//! stale, is ignored.
+//==============================================================================
 class timekeeper {
 public:
     using clock      = std::chrono::high_resolution_clock;
     using duration   = clock::duration;
     using time_point = clock::time_point;
-    using delta      = std::chrono::milliseconds;
+    using delta      = std::chrono::duration<double, std::milli>; //!< not truncated.
     using callback   = std::function<void (delta dt)>;
-    
-    struct handle { size_t id; };
+
+    struct handle {
+        uint32_t id;
+        uint32_t generation;
+    };
 
     struct record {
         timekeeper::handle     handle;
         timekeeper::callback   callback;
         timekeeper::duration   period;
         timekeeper::time_point deadline;
+        timekeeper::duration   remaining; //!< time left to the deadline while paused.
+        bool                   paused;
     };
 
-    timekeeper();
+    //! @param resolution The length of a tick.
+    explicit timekeeper(duration resolution = std::chrono::milliseconds(1));
 
-    //! Register a callback @c f to be called every @c period of time.
+    //! Register a callback @c f to be called every @c period of time, starting
+    //! one period after the last update().
     template <typename T>
     handle register_event(T period, callback f) {
         return register_event_(
@@ -36,18 +57,65 @@ public:
         );
     }
 
+    //! Unregister the event for @c h; its callback is released.
+    //! @returns false if @c h is stale.
+    bool cancel(handle h);
+
+    //! Stop the event for @c h from firing, keeping the time left to its
+    //! deadline.
+    //! @returns false if @c h is stale.
+    bool pause(handle h);
+
+    //! Continue a paused event; it is due after the time it had left.
+    //! @returns false if @c h is stale.
+    bool resume(handle h);
+
+    //! Change the period of the event for @c h; it is next due one new period
+    //! after the last update(). A paused event stays paused.
+    //! @returns false if @c h is stale.
+    template <typename T>
+    bool set_period(handle const h, T const period) {
+        return set_period_(h, std::chrono::duration_cast<duration>(period));
+    }
+
+    //! @returns Whether @c h refers to a registered event.
+    bool contains(handle h) const BK_NOEXCEPT;
+
+    //! @returns Whether @c h refers to a paused event.
+    bool is_paused(handle h) const BK_NOEXCEPT;
+
     //! Update the time and execute all callbacks which have met or exceeded
     //! their deadlines.
     void update();
-private:
-    bool heap_predidate_(uint16_t a, uint16_t b) const BK_NOEXCEPT {
-        return records_[a].deadline > records_[b].deadline;
-    }
 
+    //! As above, at the given time.
+    //! @pre now is not earlier than the last update.
+    void update(time_point now);
+
+    //! The time of the last update, or of construction.
+    time_point now() const BK_NOEXCEPT { return now_; }
+
+    //! The number of registered events, paused or not.
+    size_t size() const BK_NOEXCEPT { return records_.size() - free_.size(); }
+private:
     handle register_event_(duration period, callback f);
+    bool   set_period_(handle h, duration period);
+
+    //! @returns The record for @c h, or nullptr if @c h is stale.
+    record* find_(handle h) BK_NOEXCEPT;
+
+    //! The tick containing @c t.
+    timing_wheel::tick_t tick_floor_(time_point t) const BK_NOEXCEPT;
+    //! The first tick starting at or after @c t.
+    timing_wheel::tick_t tick_ceil_(time_point t) const BK_NOEXCEPT;
+
+    time_point start_;      //!< the start of tick 0.
+    time_point now_;
+    duration   resolution_;
 
-    std::vector<record>   records_;
-    std::vector<uint16_t> heap_;
+    std::deque<record>    records_; //!< indexed by handle; stable while firing.
+    std::vector<uint32_t> free_;    //!< cancelled slots of records_.
+    timing_wheel          wheel_;
 };
 
 } // namespace bklib
@@ -0,0 +1,172 @@
+#include "pch.hpp"
+#include "timing_wheel.hpp"
+
+using wheel  = bklib::timing_wheel;
+using id_t   = wheel::id_t;
+using tick_t = wheel::tick_t;
+
+namespace {
+    size_t const LEVEL0_SIZE = size_t {1} << wheel::LEVEL0_BITS;
+    size_t const LEVELN_SIZE = size_t {1} << wheel::LEVELN_BITS;
+    size_t const LEVEL0_MASK = LEVEL0_SIZE - 1;
+    size_t const LEVELN_MASK = LEVELN_SIZE - 1;
+
+    //! Index of the first slot of @c level in heads_.
+    size_t first_slot(size_t const level) BK_NOEXCEPT {
+        return level ? LEVEL0_SIZE + (level - 1) * LEVELN_SIZE : 0;
+    }
+
+    //! Bits of a tick below the slot index of @c level.
+    size_t level_shift(size_t const level) BK_NOEXCEPT {
+        return level ? wheel::LEVEL0_BITS + (level - 1) * wheel::LEVELN_BITS : 0;
+    }
+
+    size_t const EXPIRING = first_slot(wheel::LEVELS);
+
+    //! The furthest ahead of the next tick that the wheel can represent.
+    tick_t const SPAN = tick_t {1} << level_shift(wheel::LEVELS);
+} //namespace
+
+//==============================================================================
+wheel::timing_wheel()
+  : heads_(EXPIRING + 1, id_t {NIL})
+  , now_ {0}
+  , size_ {0}
+  , level0_size_ {0}
+{
+}
+
+//==============================================================================
+bool wheel::contains(id_t const id) const BK_NOEXCEPT {
+    return id < nodes_.size() && nodes_[id].slot != NIL;
+}
+
+tick_t wheel::due(id_t const id) const BK_NOEXCEPT {
+    BK_ASSERT(contains(id));
+    return nodes_[id].when;
+}
+
+//==============================================================================
+void wheel::insert(id_t const id, tick_t const when) {
+    BK_ASSERT(id != NIL);
+
+    if (id >= nodes_.size()) {
+        node const empty = {NIL, NIL, NIL, 0};
+        nodes_.resize(static_cast<size_t>(id) + 1, empty);
+    }
+
+    BK_ASSERT(!contains(id));
+
+    nodes_[id].when = std::max(when, now_ + 1);
+    link_(id);
+    ++size_;
+}
+
+void wheel::remove(id_t const id) BK_NOEXCEPT {
+    if (!contains(id)) return;
+
+    unlink_(id);
+    --size_;
+}
+
+//==============================================================================
+void wheel::link_(id_t const id) {
+    auto& n = nodes_[id];
+
+    //relative to the next tick to be expired.
+    auto const base  = now_ + 1;
+    auto const delta = n.when - base;
+
+    size_t slot;
+    if (delta < LEVEL0_SIZE) {
+        slot = static_cast<size_t>(n.when & LEVEL0_MASK);
+        ++level0_size_;
+    } else {
+        //beyond the last level; park in the furthest slot and cascade again.
+        auto const when = (delta < SPAN) ? n.when : base + SPAN - 1;
+
+        size_t level = 1;
+        while ((delta >> level_shift(level + 1)) != 0 && level + 1 < LEVELS) {
+            ++level;
+        }
+
+        slot = first_slot(level)
+             + static_cast<size_t>((when >> level_shift(level)) & LEVELN_MASK);
+    }
+
+    n.slot = static_cast<uint32_t>(slot);
+    n.prev = NIL;
+    n.next = heads_[slot];
+
+    if (n.next != NIL) nodes_[n.next].prev = id;
+    heads_[slot] = id;
+}
+
+void wheel::unlink_(id_t const id) BK_NOEXCEPT {
+    auto& n = nodes_[id];
+
+    if (n.prev != NIL) {
+        nodes_[n.prev].next = n.next;
+    } else {
+        heads_[n.slot] = n.next;
+    }
+
+    if (n.next != NIL) nodes_[n.next].prev = n.prev;
+
+    if (n.slot < LEVEL0_SIZE) --level0_size_;
+
+    n.slot = NIL;
+}
+
+//==============================================================================
+void wheel::cascade_(size_t const slot) {
+    auto id = heads_[slot];
+    heads_[slot] = NIL;
+
+    while (id != NIL) {
+        auto const next = nodes_[id].next;
+        link_(id);
+        id = next;
+    }
+}
+
+void wheel::step_(tick_t const to) {
+    //nothing is due before the next cascade; skip to just before it.
+    if (level0_size_ == 0) {
+        now_ = std::max(now_, std::min<tick_t>(now_ | LEVEL0_MASK, to - 1));
+    }
+
+    auto const tick = now_ + 1;
+
+    //each level wraps into the one below; cascade the slot now current.
+    for (size_t level = 1; level < LEVELS; ++level) {
+        if ((tick & ((tick_t {1} << level_shift(level)) - 1)) != 0) break;
+
+        auto const index = static_cast<size_t>((tick >> level_shift(level)) & LEVELN_MASK);
+        cascade_(first_slot(level) + index);
+    }
+
+    now_ = tick;
+
+    //move the due entries to the expiring list.
+    auto const slot = static_cast<size_t>(tick & LEVEL0_MASK);
+    BK_ASSERT(heads_[EXPIRING] == NIL);
+
+    for (auto id = heads_[slot]; id != NIL; id = nodes_[id].next) {
+        nodes_[id].slot = static_cast<uint32_t>(EXPIRING);
+        --level0_size_;
+    }
+
+    heads_[EXPIRING] = heads_[slot];
+    heads_[slot] = NIL;
+}
+
+id_t wheel::pop_expiring_() BK_NOEXCEPT {
+    auto const id = heads_[EXPIRING];
+    if (id == NIL) return NIL;
+
+    unlink_(id);
+    --size_;
+
+    return id;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+
+#include "config.hpp"
+#include "types.hpp"
+#include "assert.hpp"
+
+namespace bklib {
+
+//==============================================================================
+//! Hierarchical timing wheel.
+//!
+//! Schedules entries, identified by small integer ids, to expire at a tick.
+//! Level 0 has a slot for each of the next 256 ticks; each further level has
+//! 64 slots, each covering a whole revolution of the level below. Entries are
+//! inserted into the coarsest slot that still separates them and cascade
+//! down a level each time the level below wraps around.
+//!
+//! Entries are nodes of intrusive doubly linked lists indexed by id, so
+//! insert, remove and expiry are O(1) (amortized over cascades) and nothing is
+//! allocated beyond growing the node array to the largest id seen.
+//==============================================================================
+class timing_wheel {
+public:
+    using id_t   = uint32_t;
+    using tick_t = uint64_t;
+
+    static size_t const LEVEL0_BITS = 8;
+    static size_t const LEVELN_BITS = 6;
+    static size_t const LEVELS      = 4;
+
+    //! Ticks are 0 at construction.
+    timing_wheel();
+
+    //! The last tick that has been expired.
+    tick_t now() const BK_NOEXCEPT { return now_; }
+
+    //! The number of entries scheduled.
+    size_t size() const BK_NOEXCEPT { return size_; }
+    bool   empty() const BK_NOEXCEPT { return size_ == 0; }
+
+    bool contains(id_t id) const BK_NOEXCEPT;
+
+    //! @returns The tick @c id is due at.
+    //! @pre contains(id)
+    tick_t due(id_t id) const BK_NOEXCEPT;
+
+    //! Schedule @c id to expire at tick @c when; a tick which has already
+    //! passed is treated as the next one.
+    //! @pre !contains(id)
+    void insert(id_t id, tick_t when);
+
+    //! Unschedule @c id if it is scheduled.
+    void remove(id_t id) BK_NOEXCEPT;
+
+    //! Expire every entry due at or before @c to, in tick order, calling
+    //! on_expire(id) for each after it has been removed. on_expire may insert
+    //! and remove entries; inserts for ticks not after the current one are
+    //! due on the next tick.
+    template <typename F>
+    void advance(tick_t const to, F on_expire) {
+        while (now_ < to) {
+            if (empty()) {
+                now_ = to;
+                break;
+            }
+
+            step_(to);
+
+            for (auto id = pop_expiring_(); id != NIL; id = pop_expiring_()) {
+                on_expire(id);
+            }
+        }
+    }
+private:
+    static id_t const NIL = static_cast<id_t>(-1);
+
+    struct node {
+        id_t   prev;
+        id_t   next;
+        uint32_t slot; //!< index into heads_ or NIL when not scheduled.
+        tick_t when;
+    };
+
+    //! Link @c id into the slot for its due tick relative to now_.
+    void link_(id_t id);
+    void unlink_(id_t id) BK_NOEXCEPT;
+
+    //! Advance now_ to the next tick at or before @c to which may have entries
+    //! due, cascading as needed, and move those entries to the expiring list.
+    void step_(tick_t to);
+
+    //! Move every entry of the slot at heads_[slot] down the hierarchy.
+    void cascade_(size_t slot);
+
+    //! @returns The next entry to expire, removed, or NIL.
+    id_t pop_expiring_() BK_NOEXCEPT;
+
+    std::vector<node> nodes_;
+    std::vector<id_t> heads_; //!< the slots of each level then the expiring list.
+
+    tick_t now_;
+    size_t size_;
+    size_t level0_size_; //!< entries in level 0; when 0, ticks can be skipped.
+};
+
+} //namespace bklib
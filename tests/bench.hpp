@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include <gtest/gtest.h>
+
+//==============================================================================
+// Helpers shared by the timing benchmarks. These are only built for the
+// Release Test configuration; the numbers are written to stdout and recorded
+// as test properties so that they appear in the xml output.
+//==============================================================================
+namespace bench {
+
+using clock = std::chrono::high_resolution_clock;
+
+//! @returns The best time in ms out of @c reps runs of @c f.
+template <typename F>
+double time_ms(int const reps, F f) {
+    auto best = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < reps; ++i) {
+        auto const beg = clock::now();
+        f();
+        auto const end = clock::now();
+
+        auto const ms = std::chrono::duration<double, std::milli>(end - beg).count();
+        best = std::min(best, ms);
+    }
+
+    return best;
+}
+
+inline void report(char const* name, double const ms) {
+    std::cout << "  " << std::setw(40) << std::left << name
+              << std::setw(10) << std::right << std::fixed << std::setprecision(3)
+              << ms << " ms" << std::endl;
+
+    ::testing::Test::RecordProperty(name, static_cast<int>(ms * 1000.0));
+}
+
+//==============================================================================
+// Heap use, counted by the replacement operator new and delete in
+// bench_alloc.cpp.
+//==============================================================================
+struct heap_counters {
+    uint64_t allocations; //!< calls to operator new.
+    int64_t  bytes;       //!< bytes currently allocated.
+    int64_t  peak;        //!< the most bytes allocated since reset_heap_peak().
+};
+// Bytes are as requested from operator new; reserved but untouched storage
+// counts in full.
+
+heap_counters heap_snapshot();
+
+//! Set the peak to the bytes currently allocated.
+void reset_heap_peak();
+
+//! The result of measure().
+struct measurement {
+    double   ms;          //!< the best time.
+    uint64_t allocations; //!< allocations made by one run.
+    int64_t  peak_bytes;  //!< peak heap growth during one run.
+};
+
+//! Time @c f as time_ms() does; the allocations and peak heap use are those
+//! of the first run.
+template <typename F>
+measurement measure(int const reps, F f) {
+    reset_heap_peak();
+    auto const before = heap_snapshot();
+
+    auto const beg = clock::now();
+    f();
+    auto const end = clock::now();
+
+    auto const after = heap_snapshot();
+
+    auto const first = std::chrono::duration<double, std::milli>(end - beg).count();
+    auto const best  = (reps > 1) ? std::min(first, time_ms(reps - 1, f)) : first;
+
+    return measurement {
+        best
+      , after.allocations - before.allocations
+      , after.peak - before.bytes
+    };
+}
+
+//! Report @c m along with the rate of @c items per second.
+inline void report(char const* name, measurement const& m, size_t const items) {
+    auto const rate = (m.ms > 0.0) ? static_cast<double>(items) * 1000.0 / m.ms : 0.0;
+
+    std::cout << "  " << std::setw(40) << std::left << name
+              << std::setw(10) << std::right << std::fixed << std::setprecision(3)
+              << m.ms << " ms"
+              << std::setw(12) << std::setprecision(0) << rate << " /s"
+              << std::setw(10) << m.allocations << " allocs"
+              << std::setw(10) << (m.peak_bytes / 1024) << " KiB peak"
+              << std::endl;
+
+    std::string const key = name;
+    ::testing::Test::RecordProperty(key, static_cast<int>(m.ms * 1000.0));
+    ::testing::Test::RecordProperty(key + " allocs", static_cast<int>(m.allocations));
+    ::testing::Test::RecordProperty(key + " peak KiB", static_cast<int>(m.peak_bytes / 1024));
+}
+
+} //namespace bench
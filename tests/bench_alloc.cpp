@@ -0,0 +1,111 @@
+#include "pch.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "bench.hpp"
+
+//==============================================================================
+// Replacement global operator new and delete which count allocations and the
+// bytes in use for the benchmarks. Each block is prefixed with its size.
+//==============================================================================
+namespace {
+
+//! Keeps the returned pointer aligned as malloc's is.
+size_t const HEADER_SIZE = 16;
+
+std::atomic<uint64_t> allocations {0};
+std::atomic<int64_t>  bytes {0};
+std::atomic<int64_t>  peak {0};
+
+void* allocate(size_t const size) BK_NOEXCEPT {
+    auto const block = static_cast<char*>(std::malloc(size + HEADER_SIZE));
+    if (!block) return nullptr;
+
+    *reinterpret_cast<size_t*>(block) = size;
+
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    auto const now = bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed)
+                   + static_cast<int64_t>(size);
+
+    auto old = peak.load(std::memory_order_relaxed);
+    while (now > old && !peak.compare_exchange_weak(old, now, std::memory_order_relaxed)) {
+    }
+
+    return block + HEADER_SIZE;
+}
+
+void* allocate_or_throw(size_t const size) {
+    for (;;) {
+        if (auto const result = allocate(size)) return result;
+
+        auto const handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc {};
+        handler();
+    }
+}
+
+void deallocate(void* const p) BK_NOEXCEPT {
+    if (!p) return;
+
+    auto const block = static_cast<char*>(p) - HEADER_SIZE;
+    auto const size  = *reinterpret_cast<size_t*>(block);
+
+    bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    std::free(block);
+}
+
+} //namespace
+
+bench::heap_counters bench::heap_snapshot() {
+    return heap_counters {
+        allocations.load(std::memory_order_relaxed)
+      , bytes.load(std::memory_order_relaxed)
+      , peak.load(std::memory_order_relaxed)
+    };
+}
+
+void bench::reset_heap_peak() {
+    peak.store(bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void* operator new(size_t const size) {
+    return allocate_or_throw(size);
+}
+
+void* operator new[](size_t const size) {
+    return allocate_or_throw(size);
+}
+
+void* operator new(size_t const size, std::nothrow_t const&) BK_NOEXCEPT {
+    return allocate(size);
+}
+
+void* operator new[](size_t const size, std::nothrow_t const&) BK_NOEXCEPT {
+    return allocate(size);
+}
+
+void operator delete(void* const p) BK_NOEXCEPT {
+    deallocate(p);
+}
+
+void operator delete[](void* const p) BK_NOEXCEPT {
+    deallocate(p);
+}
+
+void operator delete(void* const p, size_t) BK_NOEXCEPT {
+    deallocate(p);
+}
+
+void operator delete[](void* const p, size_t) BK_NOEXCEPT {
+    deallocate(p);
+}
+
+void operator delete(void* const p, std::nothrow_t const&) BK_NOEXCEPT {
+    deallocate(p);
+}
+
+void operator delete[](void* const p, std::nothrow_t const&) BK_NOEXCEPT {
+    deallocate(p);
+}
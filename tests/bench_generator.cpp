@@ -0,0 +1,364 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "bench.hpp"
+#include "game/room.hpp"
+#include "game/spatial_hash.hpp"
+#include "game/level_generator.hpp"
+#include "game/corridors.hpp"
+#include "game/wfc.hpp"
+
+//==============================================================================
+// Timing benchmarks for level generation.
+//==============================================================================
+namespace {
+
+using bench::time_ms;
+using bench::measure;
+using bench::report;
+
+using rect = bklib::axis_aligned_rect<int>;
+
+//! A room size distribution for room_simple.
+struct size_distribution {
+    char const*                        name;
+    tez::generator::room_simple::range width;
+    tez::generator::room_simple::range height;
+};
+
+size_distribution const DISTRIBUTIONS[] = {
+    {"small",   {3,  5}, {3,  5}}
+  , {"default", {3, 10}, {3, 10}}
+  , {"large",   {8, 24}, {8, 24}}
+  , {"long",    {3, 30}, {3,  4}}
+};
+
+size_t const ROOM_COUNTS[] = {10, 100, 1000, 10000, 100000};
+
+//! layout_random is given a fixed budget so that the large counts finish.
+uint32_t const PLACEMENT_ATTEMPTS = 100;
+
+int reps_for(size_t const n) {
+    return (n <= 1000) ? 5 : 1;
+}
+
+std::string label(char const* what, size_distribution const& d, size_t const n) {
+    return std::string {what} + " " + d.name + " " + std::to_string(n);
+}
+
+//! The tiles to reserve for @c n rooms of @c d: the mean rather than the worst
+//! case, which for the large counts is most of a 32 bit address space.
+size_t expected_tiles(size_distribution const& d, size_t const n) {
+    auto const mean = [](tez::generator::room_simple::range const& r) {
+        return (r.first + r.second + 1) / 2;
+    };
+
+    return n * mean(d.width) * mean(d.height);
+}
+
+//! The most tile memory a combination may use in a 32 bit build.
+size_t const MAX_TILE_BYTES_32 = size_t {256} << 20;
+
+//! @returns Whether @c n rooms of @c d fit; skipped with a note if not.
+bool fits(size_distribution const& d, size_t const n) {
+    auto const bytes = expected_tiles(d, n) * sizeof(tez::tile_data);
+    if (sizeof(void*) > 4 || bytes <= MAX_TILE_BYTES_32) return true;
+
+    std::cout << "  " << label("skipped on 32 bit:", d, n) << std::endl;
+    return false;
+}
+
+} //namespace
+
+//==============================================================================
+// room_simple::generate for each distribution and count; one allocation per
+// room against generating into a reserved room_store. Throughput is rooms/s.
+//==============================================================================
+TEST(GeneratorBench, RoomGenerate) {
+    for (auto const& d : DISTRIBUTIONS) {
+        for (auto const n : ROOM_COUNTS) {
+            if (!fits(d, n)) continue;
+
+            auto gen = tez::generator::room_simple {d.width, d.height};
+
+            report(label("rooms", d, n).c_str(), measure(reps_for(n), [&] {
+                tez::random rand {100};
+                std::vector<tez::room> rooms;
+                rooms.reserve(n);
+
+                for (size_t i = 0; i < n; ++i) {
+                    rooms.push_back(gen.generate(rand));
+                }
+            }), n);
+
+            report(label("room_store", d, n).c_str(), measure(reps_for(n), [&] {
+                tez::random rand {100};
+                tez::room_store store;
+                store.reserve(n, expected_tiles(d, n));
+
+                for (size_t i = 0; i < n; ++i) {
+                    gen.generate(rand, store);
+                }
+            }), n);
+        }
+    }
+}
+
+//==============================================================================
+// layout_random placement followed by normalize() and to_grid() for each
+// distribution and count. Placement throughput is rooms attempted/s; to_grid
+// throughput is tiles/s.
+//==============================================================================
+TEST(GeneratorBench, LayoutPipeline) {
+    auto const budget = tez::generator::placement_budget {PLACEMENT_ATTEMPTS};
+
+    for (auto const& d : DISTRIBUTIONS) {
+        for (auto const n : ROOM_COUNTS) {
+            if (!fits(d, n)) continue;
+
+            auto gen = tez::generator::room_simple {d.width, d.height};
+            tez::generator::layout_random layout;
+
+            report(label("insert", d, n).c_str(), measure(1, [&] {
+                tez::random rand {100};
+                layout.reserve(n, expected_tiles(d, n));
+
+                for (size_t i = 0; i < n; ++i) {
+                    layout.try_generate(rand, gen, budget);
+                }
+            }), n);
+
+            std::cout << "    placed " << layout.rects_.size() << " of " << n << std::endl;
+
+            report(label("normalize", d, n).c_str(), measure(1, [&] {
+                layout.normalize();
+            }), layout.rects_.size());
+
+            size_t tiles = 0;
+            auto const m = measure(reps_for(n), [&] {
+                tiles = layout.to_grid().size();
+            });
+            report(label("to_grid", d, n).c_str(), m, tiles);
+
+            ASSERT_TRUE(layout.verify());
+        }
+    }
+}
+
+//==============================================================================
+// Room placement with layout_random; the same seed and room sizes as main.cpp.
+// The cumulative time is reported at each checkpoint so the growth of the
+// per room cost is visible.
+//==============================================================================
+TEST(GeneratorBench, LayoutRandomScaling) {
+    tez::random rand {100};
+
+    auto room_gen = tez::generator::room_simple({3, 10}, {3, 10});
+    tez::generator::layout_random layout;
+
+    size_t const checkpoints[] = {1000, 2500, 5000, 10000};
+
+    auto const beg = bench::clock::now();
+    size_t n = 0;
+
+    for (auto const count : checkpoints) {
+        for (; n < count; ++n) {
+            layout.insert(rand, room_gen.generate(rand));
+        }
+
+        auto const ms = std::chrono::duration<double, std::milli>(bench::clock::now() - beg).count();
+
+        std::string const name = "layout_random " + std::to_string(count) + " rooms";
+        report(name.c_str(), ms);
+    }
+
+    //a valid, tightly packed layout; many rooms share each column.
+    auto valid = false;
+    report("layout_random verify 10000 rooms", time_ms(5, [&] { valid = layout.verify(); }));
+    ASSERT_TRUE(valid);
+
+    using stats = tez::generator::placement_stats;
+    std::cout << "  attempts per room (min,max,count)\n";
+    stats::write_histogram(std::cout, stats::histogram(layout.stats_, &stats::attempts));
+}
+
+//==============================================================================
+// Room placement with layout_bsp; an area sized for roughly 10k rooms.
+//==============================================================================
+TEST(GeneratorBench, LayoutBsp) {
+    auto room_gen = tez::generator::room_simple({3, 10}, {3, 10});
+    tez::generator::layout_bsp layout {1600, 1600, 12};
+
+    report("layout_bsp 1600x1600", time_ms(5, [&] {
+        tez::random rand {100};
+        layout.generate(rand, room_gen);
+    }));
+
+    std::string const name = "layout_bsp links " + std::to_string(layout.rects_.size()) + " rooms";
+    report(name.c_str(), time_ms(5, [&] { layout.links(); }));
+
+    ASSERT_TRUE(bklib::intersecting_pairs(layout.rects_).empty());
+}
+
+//==============================================================================
+// Overlap queries against 10k placed rooms; spatial_hash against the linear
+// scan it replaced.
+//==============================================================================
+TEST(GeneratorBench, RectQueries) {
+    std::mt19937 rand {1};
+    std::uniform_int_distribution<int> pos  {0, 2000};
+    std::uniform_int_distribution<int> size {3, 12};
+
+    tez::spatial_hash index;
+    std::vector<rect> rects;
+
+    while (rects.size() < 10000) {
+        auto const r = rect {rect::tl_point {pos(rand), pos(rand)}, size(rand), size(rand)};
+        if (index.any_intersecting(r)) continue;
+
+        index.insert(r);
+        rects.push_back(r);
+    }
+
+    std::vector<rect> queries;
+    for (int i = 0; i < 10000; ++i) {
+        queries.push_back(rect {rect::tl_point {pos(rand), pos(rand)}, size(rand), size(rand)});
+    }
+
+    size_t expected = 0;
+    report("linear scan 10k x 10k", time_ms(1, [&] {
+        expected = 0;
+        for (auto const& q : queries) {
+            expected += std::any_of(std::begin(rects), std::end(rects)
+              , [&](rect const& r) { return bklib::intersects(q, r); }) ? 1 : 0;
+        }
+    }));
+
+    size_t actual = 0;
+    report("spatial_hash 10k x 10k", time_ms(5, [&] {
+        actual = 0;
+        for (auto const& q : queries) {
+            actual += index.any_intersecting(q) ? 1 : 0;
+        }
+    }));
+
+    ASSERT_EQ(expected, actual);
+
+    //whole set verification as in layout_random::verify().
+    size_t pairs = 0;
+    report("sweep and prune 10k", time_ms(5, [&] {
+        pairs = bklib::intersecting_pairs(rects).size();
+    }));
+
+    ASSERT_EQ(pairs, 0u);
+}
+
+//==============================================================================
+// Batch generation of main.cpp sized levels on one thread and on every
+// hardware thread.
+//==============================================================================
+TEST(GeneratorBench, LevelBatch) {
+    auto const gen = tez::level_generator {};
+    size_t const n = 64;
+
+    bklib::thread_pool serial {1};
+    bklib::thread_pool parallel;
+
+    size_t a = 0;
+    size_t b = 0;
+
+    report("64 levels, 1 thread", time_ms(1, [&] {
+        a = gen.generate_batch(serial, 42, 0, n).size();
+    }));
+
+    std::string const name = "64 levels, " + std::to_string(parallel.size()) + " threads";
+    report(name.c_str(), time_ms(1, [&] {
+        b = gen.generate_batch(parallel, 42, 0, n).size();
+    }));
+
+    ASSERT_EQ(a, n);
+    ASSERT_EQ(b, n);
+}
+
+//==============================================================================
+// Corridor graph construction over room centers.
+//==============================================================================
+TEST(GeneratorBench, CorridorGraph) {
+    using point = tez::generator::corridors::point;
+
+    std::mt19937 rand {2};
+    std::uniform_int_distribution<int> coord {0, 20000};
+
+    for (size_t const n : {1000u, 10000u, 100000u}) {
+        std::vector<point> points;
+        std::unordered_set<uint64_t> used;
+
+        while (points.size() < n) {
+            auto const x = coord(rand);
+            auto const y = coord(rand);
+            if (!used.insert(static_cast<uint64_t>(x) << 32 | static_cast<uint32_t>(y)).second) continue;
+            points.push_back(point {static_cast<float>(x), static_cast<float>(y)});
+        }
+
+        size_t tree = 0;
+        std::string const name = "delaunay + mst " + std::to_string(n);
+        report(name.c_str(), time_ms(3, [&] {
+            auto const edges = tez::generator::delaunay_edges(points);
+            tree = tez::generator::minimum_spanning_tree(points, edges).size();
+        }));
+
+        ASSERT_EQ(tree, n - 1);
+    }
+}
+
+//==============================================================================
+// Wave function collapse; 256x256 maps from a small cave sample. Restarts
+// after a contradiction are included in the time.
+//==============================================================================
+TEST(GeneratorBench, Wfc) {
+    char const* const sample_rows[] = {
+        "################"
+      , "###....#########"
+      , "##......###..###"
+      , "#........#....##"
+      , "#..............#"
+      , "##............##"
+      , "###..##.......##"
+      , "####.###.....###"
+      , "###..####...####"
+      , "##....###...####"
+      , "#......#.....###"
+      , "#.............##"
+      , "##............##"
+      , "###...##.....###"
+      , "#######..#######"
+      , "################"
+    };
+
+    tez::grid2d<tez::tile_data> sample {16, 16};
+    for (size_t y = 0; y < sample.height(); ++y) {
+        for (size_t x = 0; x < sample.width(); ++x) {
+            sample[{x, y}] = tez::tile_data {sample_rows[y][x] == '#'
+              ? tez::tile_type::wall : tez::tile_type::floor};
+        }
+    }
+
+    tez::grid2d<tez::tile_data> out {256, 256};
+
+    for (unsigned const n : {2u, 3u}) {
+        auto const model = tez::generator::wfc {sample, n};
+
+        unsigned seed = 0;
+        bool ok = true;
+
+        std::string const name = "wfc 256x256, n = " + std::to_string(n) + ", "
+          + std::to_string(model.pattern_count()) + " patterns";
+
+        report(name.c_str(), time_ms(5, [&] {
+            tez::random rand {seed++};
+            ok = ok && model.generate(rand, out, 100);
+        }));
+
+        ASSERT_TRUE(ok);
+    }
+}
@@ -0,0 +1,254 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "bench.hpp"
+#include "game/grid2d.hpp"
+#include "game/tile_data.hpp"
+#include "game/room.hpp"
+#include "game/noise.hpp"
+
+//==============================================================================
+// Timing benchmarks for grid2d.
+//==============================================================================
+namespace {
+
+using bench::time_ms;
+using bench::report;
+
+size_t const MAP_SIZE = 1024;
+int    const REPS     = 5;
+
+//! Fill the map with a deterministic scatter of walls.
+template <typename Grid>
+void fill_map(Grid& g) {
+    std::mt19937 rand {1234};
+    std::bernoulli_distribution is_wall {0.25};
+
+    for (size_t y = 0; y < g.height(); ++y) {
+        for (size_t x = 0; x < g.width(); ++x) {
+            g[{x, y}].type = is_wall(rand) ? tez::tile_type::wall : tez::tile_type::floor;
+        }
+    }
+
+    g[{g.width() / 2, g.height() / 2}].type = tez::tile_type::floor;
+}
+
+//! 3x3 wall count at every interior tile; a typical autotiling kernel.
+template <typename Grid>
+size_t kernel_stencil(Grid const& g) {
+    size_t result = 0;
+
+    for (size_t y = 1; y < g.height() - 1; ++y) {
+        for (size_t x = 1; x < g.width() - 1; ++x) {
+            for (size_t dy = y - 1; dy <= y + 1; ++dy) {
+                for (size_t dx = x - 1; dx <= x + 1; ++dx) {
+                    result += (g[{dx, dy}].type == tez::tile_type::wall);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+//! Square neighbourhood scans of radius R about random points; approximates
+//! field of view and local placement queries.
+template <typename Grid>
+size_t kernel_local_scan(Grid const& g) {
+    size_t const R = 12;
+    size_t const N = 20000;
+
+    std::mt19937 rand {4321};
+    std::uniform_int_distribution<size_t> dist {R, MAP_SIZE - R - 1};
+
+    size_t result = 0;
+
+    for (size_t i = 0; i < N; ++i) {
+        auto const cx = dist(rand);
+        auto const cy = dist(rand);
+
+        for (auto x = cx - R; x <= cx + R; ++x) {
+            for (auto y = cy - R; y <= cy + R; ++y) {
+                result += (g[{x, y}].type == tez::tile_type::floor);
+            }
+        }
+    }
+
+    return result;
+}
+
+//! 4-connected flood fill from the center; approximates pathfinding.
+template <typename Grid>
+size_t kernel_flood_fill(Grid const& g) {
+    using index = typename Grid::index;
+
+    std::vector<uint8_t> visited(g.width() * g.height(), 0);
+    std::vector<index>   open;
+
+    auto const push = [&](index const i) {
+        auto& v = visited[i.y * g.width() + i.x];
+        if (v || g[i].type == tez::tile_type::wall) return;
+        v = 1;
+        open.push_back(i);
+    };
+
+    push(index {g.width() / 2, g.height() / 2});
+
+    size_t result = 0;
+    while (!open.empty()) {
+        auto const i = open.back();
+        open.pop_back();
+        ++result;
+
+        if (i.x > 0)              push(index {i.x - 1, i.y});
+        if (i.x < g.width() - 1)  push(index {i.x + 1, i.y});
+        if (i.y > 0)              push(index {i.x, i.y - 1});
+        if (i.y < g.height() - 1) push(index {i.x, i.y + 1});
+    }
+
+    return result;
+}
+
+template <typename Layout>
+void run_layout(char const* name) {
+    using grid = tez::grid2d<tez::tile_data, Layout>;
+
+    auto g = grid(MAP_SIZE, MAP_SIZE);
+    fill_map(g);
+
+    std::cout << name << std::endl;
+
+    size_t sink = 0;
+    report("stencil 3x3",     time_ms(REPS, [&] { sink += kernel_stencil(g); }));
+    report("local scan r=12", time_ms(REPS, [&] { sink += kernel_local_scan(g); }));
+    report("flood fill",      time_ms(REPS, [&] { sink += kernel_flood_fill(g); }));
+
+    ASSERT_GT(sink, 0u);
+}
+
+} //namespace
+
+TEST(Grid2dBench, LayoutNeighbourhood) {
+    run_layout<tez::layout_row_major>("row major");
+    run_layout<tez::layout_blocked<8>>("blocked 8x8");
+    run_layout<tez::layout_blocked<16>>("blocked 16x16");
+}
+
+//==============================================================================
+// Full map traversal; compares each iteration mode against a raw pointer loop
+// doing the same per tile work as the render loop.
+//==============================================================================
+TEST(Grid2dBench, FullTraversal) {
+    using grid = tez::grid2d<tez::tile_data>;
+
+    auto g = grid(MAP_SIZE, MAP_SIZE);
+    fill_map(g);
+
+    auto const& cg = g;
+    auto const  w  = cg.width();
+    auto const  h  = cg.height();
+
+    size_t expected = 0;
+    size_t actual   = 0;
+
+    report("raw pointer", time_ms(REPS, [&] {
+        auto const first = &cg[{0, 0}];
+        expected = 0;
+        for (size_t y = 0; y < h; ++y) {
+            auto const row = first + y * w;
+            for (size_t x = 0; x < w; ++x) {
+                if (row[x].type != tez::tile_type::empty) {
+                    expected += static_cast<size_t>(row[x].type) + x + y;
+                }
+            }
+        }
+    }));
+
+    report("grid_iterator", time_ms(REPS, [&] {
+        actual = 0;
+        for (auto const& i : cg) {
+            if (i.value.type != tez::tile_type::empty) {
+                actual += static_cast<size_t>(i.value.type) + i.i.x + i.i.y;
+            }
+        }
+    }));
+    ASSERT_EQ(expected, actual);
+
+    report("rows", time_ms(REPS, [&] {
+        actual = 0;
+        for (auto const row : cg.rows()) {
+            for (size_t x = 0; x < row.values.size(); ++x) {
+                if (row.values[x].type != tez::tile_type::empty) {
+                    actual += static_cast<size_t>(row.values[x].type) + x + row.y;
+                }
+            }
+        }
+    }));
+    ASSERT_EQ(expected, actual);
+
+    report("grid_view iterator", time_ms(REPS, [&] {
+        actual = 0;
+        for (auto const& i : cg.view()) {
+            if (i.value.type != tez::tile_type::empty) {
+                actual += static_cast<size_t>(i.value.type) + i.i.x + i.i.y;
+            }
+        }
+    }));
+    ASSERT_EQ(expected, actual);
+}
+
+//==============================================================================
+// Cave generation; one cellular automaton step and a whole 4k x 4k cave.
+//==============================================================================
+TEST(Grid2dBench, CaveAutomaton) {
+    unsigned const size = 4096;
+
+    auto const gen = tez::generator::room_cave {size, size};
+
+    tez::random rand {99};
+    auto board = gen.generate_bits(rand);
+    auto next  = tez::bitboard {size, size};
+
+    report("cave step 4096x4096", time_ms(REPS, [&] {
+        board.step(gen.rule_, next, true);
+    }));
+
+    size_t sink = 0;
+    report("cave generate 4096x4096", time_ms(REPS, [&] {
+        sink += gen.generate_bits(rand).count();
+    }));
+
+    ASSERT_GT(sink, 0u);
+}
+
+//==============================================================================
+// Fractal noise over a 1024x1024 region; the scalar and vectorized paths and
+// a byte plane.
+//==============================================================================
+TEST(Grid2dBench, NoiseFill) {
+    unsigned const size = 1024;
+
+    auto const noise = tez::simplex_noise {5};
+    tez::noise_params p;
+
+    tez::grid2d<float>   values {size, size};
+    tez::grid2d<float>   scalar {size, size};
+    tez::grid2d<uint8_t> bytes  {size, size};
+
+    report("noise 4 octaves 1024x1024 scalar", time_ms(REPS, [&] {
+        noise.fill(scalar, p, 0.0f, 0.0f, false);
+    }));
+
+    std::string const name = std::string {"noise 4 octaves 1024x1024 "}
+      + (tez::simplex_noise::has_simd() ? "sse2" : "scalar");
+
+    report(name.c_str(), time_ms(REPS, [&] {
+        noise.fill(values, p);
+    }));
+
+    report("noise 4 octaves 1024x1024 bytes", time_ms(REPS, [&] {
+        noise.fill(bytes, p);
+    }));
+
+    ASSERT_EQ(0, std::memcmp(&values[{0, 0}], &scalar[{0, 0}], values.size() * sizeof(float)));
+}
@@ -0,0 +1,90 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "bench.hpp"
+#include "timekeeper.hpp"
+
+#include <memory>
+#include <random>
+#include <string>
+
+//==============================================================================
+// Timing benchmarks for timekeeper.
+//==============================================================================
+namespace {
+
+using bench::measure;
+using bench::report;
+
+using tk = bklib::timekeeper;
+using std::chrono::milliseconds;
+
+size_t const EVENT_COUNTS[] = {1000, 10000, 100000, 500000};
+int    const SIMULATED_MS   = 10000;
+int    const REPS           = 3;
+
+//! Register @c n events with periods of 1ms to 10s and update every
+//! millisecond for SIMULATED_MS.
+//! @returns The number of callbacks made.
+size_t run_timekeeper(size_t const n) {
+    std::mt19937 rand {1234};
+    std::uniform_int_distribution<int> period {1, 10000};
+
+    tk time;
+    auto const start = time.now();
+
+    size_t fired = 0;
+    for (size_t i = 0; i < n; ++i) {
+        time.register_event(milliseconds(period(rand)), [&](tk::delta) { ++fired; });
+    }
+
+    for (int ms = 1; ms <= SIMULATED_MS; ++ms) {
+        time.update(start + milliseconds(ms));
+    }
+
+    return fired;
+}
+
+} //namespace
+
+TEST(TimekeeperBench, ManyEvents) {
+    std::cout << "timekeeper: " << SIMULATED_MS << " updates of 1ms" << std::endl;
+
+    for (auto const n : EVENT_COUNTS) {
+        size_t fired = 0;
+        auto const m = measure(REPS, [&] { fired = run_timekeeper(n); });
+
+        auto const name = std::to_string(n) + " events";
+        report(name.c_str(), m, fired);
+    }
+}
+
+TEST(TimekeeperBench, ShortLivedEvents) {
+    size_t const PER_UPDATE = 100;
+
+    std::cout << "timekeeper: " << PER_UPDATE << " one-shot events per update" << std::endl;
+
+    size_t fired = 0;
+    auto const m = measure(REPS, [&] {
+        std::mt19937 rand {1234};
+        std::uniform_int_distribution<int> delay {1, 50};
+
+        tk time;
+        auto const start = time.now();
+
+        fired = 0;
+        for (int ms = 1; ms <= SIMULATED_MS; ++ms) {
+            for (size_t i = 0; i < PER_UPDATE; ++i) {
+                auto const h = std::make_shared<tk::handle>();
+                *h = time.register_event(milliseconds(delay(rand)), [&, h](tk::delta) {
+                    ++fired;
+                    time.cancel(*h);
+                });
+            }
+
+            time.update(start + milliseconds(ms));
+        }
+    });
+
+    report("register, fire and cancel", m, fired);
+}
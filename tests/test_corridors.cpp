@@ -0,0 +1,186 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "game/grid2d.hpp"
+#include "game/level_generator.hpp"
+#include "game/corridors.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+TEST(Corridors, DelaunayContainsMinimumSpanningTree) {
+    using namespace tez::generator;
+    using point = corridors::point;
+
+    std::mt19937 rand {9};
+    std::uniform_int_distribution<int> coord {0, 60};
+
+    //integral coordinates give many collinear and cocircular points.
+    std::vector<point> points;
+    for (int i = 0; i < 300; ++i) {
+        auto const p = point {static_cast<float>(coord(rand)), static_cast<float>(coord(rand))};
+        auto const dup = std::any_of(std::begin(points), std::end(points), [&](point const& q) {
+            return q.x == p.x && q.y == p.y;
+        });
+        if (!dup) points.push_back(p);
+    }
+
+    auto const n = points.size();
+    auto const edges = delaunay_edges(points);
+    ASSERT_LE(edges.size(), 3 * n - 6);
+
+    auto const length = [&](size_t const a, size_t const b) {
+        return std::hypot(double {points[a].x} - points[b].x, double {points[a].y} - points[b].y);
+    };
+
+    //the euclidean MST is a subgraph of the triangulation; compare weights
+    //against Prim over the complete graph.
+    auto const tree = minimum_spanning_tree(points, edges);
+    ASSERT_EQ(tree.size(), n - 1);
+
+    double tree_weight = 0.0;
+    for (auto const& e : tree) tree_weight += length(e.first, e.second);
+
+    std::vector<double> best(n, std::numeric_limits<double>::max());
+    std::vector<bool>   done(n, false);
+    best[0] = 0.0;
+
+    double prim_weight = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        size_t u = n;
+        for (size_t i = 0; i < n; ++i) {
+            if (!done[i] && (u == n || best[i] < best[u])) u = i;
+        }
+
+        done[u] = true;
+        prim_weight += best[u];
+
+        for (size_t i = 0; i < n; ++i) {
+            if (!done[i]) best[i] = std::min(best[i], length(u, i));
+        }
+    }
+
+    ASSERT_NEAR(tree_weight, prim_weight, 1e-6);
+}
+
+TEST(Corridors, CarveMarksOnlyChangedBlocks) {
+    using namespace tez;
+    using generator::corridors;
+    using rect  = corridors::rect;
+    using index = grid2d<tile_data>::index;
+
+    //two walled rooms in a corner each; the corridor crosses empty space.
+    grid2d<tile_data> g {64, 64};
+    std::vector<rect> const rects = {rect {2, 2, 9, 9}, rect {50, 50, 60, 58}};
+
+    for (auto const& r : rects) {
+        for (auto y = r.top(); y < r.bottom(); ++y) {
+            for (auto x = r.left(); x < r.right(); ++x) {
+                auto const edge = y == r.top() || x == r.left()
+                               || y == r.bottom() - 1 || x == r.right() - 1;
+                g[index {static_cast<size_t>(x), static_cast<size_t>(y)}]
+                    = tile_data {edge ? tile_type::wall : tile_type::floor};
+            }
+        }
+    }
+
+    std::vector<tile_type> before;
+    for (auto const& i : static_cast<grid2d<tile_data> const&>(g)) {
+        before.push_back(i.value.type);
+    }
+
+    g.enable_dirty_tracking(8);
+
+    tez::random rand {7};
+    corridors {}.carve(g, rects, {corridors::link {0, 1}}, rand);
+
+    //a block is dirty exactly when some tile in it changed.
+    std::vector<bool> changed((64 / 8) * (64 / 8), false);
+    for (size_t y = 0; y < 64; ++y) {
+        for (size_t x = 0; x < 64; ++x) {
+            if (g.get({x, y}).type != before[y * 64 + x]) {
+                changed[(y / 8) * 8 + x / 8] = true;
+            }
+        }
+    }
+
+    size_t changed_count = 0;
+    for (size_t b = 0; b < changed.size(); ++b) {
+        auto const i = index {(b % 8) * 8, (b / 8) * 8};
+        ASSERT_EQ(changed[b], g.dirty().is_dirty(i)) << i.x << ", " << i.y;
+        changed_count += changed[b] ? 1 : 0;
+    }
+
+    ASSERT_GT(changed_count, 0u);
+    ASSERT_LT(changed_count, changed.size() / 2);
+}
+
+TEST(Corridors, LevelIsConnected) {
+    using namespace tez;
+
+    level_generator::params p;
+    p.room_count = 30;
+
+    auto const level = level_generator {p}.generate(5, 0);
+
+    auto const walkable = [&](level_generator::level::index const i) {
+        auto const t = level[i].type;
+        return t == tile_type::floor || t == tile_type::door;
+    };
+
+    //flood fill from the first walkable tile reaches every walkable tile.
+    using index = level_generator::level::index;
+    std::vector<index> open;
+    std::vector<bool>  seen(level.size(), false);
+
+    size_t walkable_count = 0;
+    for (auto const& i : level) {
+        if (!walkable(i.i)) continue;
+        if (open.empty()) {
+            open.push_back(i.i);
+            seen[i.i.y * level.width() + i.i.x] = true;
+        }
+        ++walkable_count;
+    }
+
+    size_t reached = 0;
+    while (!open.empty()) {
+        auto const i = open.back();
+        open.pop_back();
+        ++reached;
+
+        index const next[] = {{i.x - 1, i.y}, {i.x + 1, i.y}, {i.x, i.y - 1}, {i.x, i.y + 1}};
+        for (auto const j : next) {
+            if (!level.is_valid(j) || !walkable(j)) continue;
+            auto const k = j.y * level.width() + j.x;
+            if (seen[k]) continue;
+            seen[k] = true;
+            open.push_back(j);
+        }
+    }
+
+    ASSERT_GT(walkable_count, 0);
+    ASSERT_EQ(reached, walkable_count);
+
+    //walkable tiles are enclosed: none touches empty space or the edge.
+    for (uint64_t seed = 0; seed < 50; ++seed) {
+        auto const other = level_generator {p}.generate(seed, 0);
+
+        for (size_t y = 0; y < other.height(); ++y) {
+            for (size_t x = 0; x < other.width(); ++x) {
+                auto const t = other[index {x, y}].type;
+                if (t != tile_type::floor && t != tile_type::door) continue;
+
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        auto const j = index {x + dx, y + dy};
+                        ASSERT_TRUE(other.is_valid(j)) << seed << ": " << x << ", " << y;
+                        ASSERT_NE(tile_type::empty, other[j].type) << seed << ": " << x << ", " << y;
+                    }
+                }
+            }
+        }
+    }
+}
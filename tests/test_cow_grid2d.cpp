@@ -0,0 +1,57 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "game/grid2d.hpp"
+#include "game/cow_grid2d.hpp"
+
+TEST(CowGrid2d, Snapshot) {
+    using grid = tez::cow_grid2d<int, 8>;
+
+    auto const w = 20;
+    auto const h = 10;
+
+    auto src = tez::grid2d<int>(w, h);
+    for (auto const& i : src) {
+        i.value = static_cast<int>(i.i.y * w + i.i.x);
+    }
+
+    auto g = grid {src};
+    ASSERT_EQ(g.chunk_count(), 3 * 2);
+    ASSERT_EQ(g.shared_chunk_count(), 0);
+
+    auto snap = g.snapshot();
+    ASSERT_EQ(g.shared_chunk_count(), g.chunk_count());
+
+    //the first write copies only the chunk written to.
+    g[{9, 1}] = -1;
+    ASSERT_EQ(g.shared_chunk_count(), g.chunk_count() - 1);
+    ASSERT_EQ(g.get({9, 1}), -1);
+    ASSERT_EQ(snap.get({9, 1}), 1 * w + 9);
+
+    //writes to the snapshot are independent too.
+    snap[{0, 0}] = -2;
+    ASSERT_EQ(g.get({0, 0}), 0);
+    ASSERT_EQ(g.shared_chunk_count(), g.chunk_count() - 2);
+
+    auto const a = g.to_grid();
+    auto const b = snap.to_grid();
+    for (auto const& i : src) {
+        auto const expected = static_cast<int>(i.i.y * w + i.i.x);
+        ASSERT_EQ(a[i.i], (i.i.x == 9 && i.i.y == 1) ? -1 : expected);
+        ASSERT_EQ(b[i.i], (i.i.x == 0 && i.i.y == 0) ? -2 : expected);
+    }
+
+    //released snapshots no longer share.
+    { auto const tmp = std::move(snap); }
+    ASSERT_EQ(g.shared_chunk_count(), 0);
+
+    //a chunk is copied once per snapshot, even if that snapshot is gone, then
+    //written in place.
+    auto const before = &g.get({2, 2});
+    g[{2, 2}] = 5;
+    auto const after = &g.get({2, 2});
+    ASSERT_NE(before, after);
+
+    g[{3, 3}] = 6;
+    ASSERT_EQ(after, &g.get({2, 2}));
+}
@@ -76,6 +76,302 @@ TEST(Grid2d, Swap) {
     for (auto const& i : grid_bb) ASSERT_EQ(i, value_b);
 }
 
+TEST(Grid2d, BlockedLayout) {
+    using row_grid   = tez::grid2d<int>;
+    using block_grid = tez::grid2d<int, tez::layout_blocked<8>>;
+
+    //deliberately not a multiple of the block size.
+    auto const w = 21;
+    auto const h = 13;
+
+    auto a = row_grid(w, h);
+    auto b = block_grid(w, h);
+
+    for (size_t y = 0; y < h; ++y) {
+        for (size_t x = 0; x < w; ++x) {
+            a[{x, y}] = static_cast<int>(y * w + x);
+            b[{x, y}] = static_cast<int>(y * w + x);
+        }
+    }
+
+    ASSERT_FALSE(b.is_valid({w, 0}));
+    ASSERT_FALSE(b.is_valid({0, h}));
+    ASSERT_GE(b.mem_size(), a.mem_size());
+
+    //iteration is in logical order for both layouts.
+    auto ia = a.cbegin();
+    auto n  = 0;
+    for (auto const& i : b) {
+        ASSERT_EQ(ia->i.x, i.i.x);
+        ASSERT_EQ(ia->i.y, i.i.y);
+        ASSERT_EQ(ia->value, i.value);
+        ASSERT_EQ(n, i.value);
+        ++ia;
+        ++n;
+    }
+    ASSERT_EQ(n, b.size());
+    ASSERT_EQ(ia, a.cend());
+}
+
+TEST(Grid2d, View) {
+    using grid = tez::grid2d<int>;
+
+    auto const w = 12;
+    auto const h = 9;
+
+    auto g = grid(w, h);
+    for (size_t y = 0; y < h; ++y) {
+        for (size_t x = 0; x < w; ++x) {
+            g[{x, y}] = static_cast<int>(y * w + x);
+        }
+    }
+
+    auto const v = g.view({2, 3}, 5, 4);
+    ASSERT_EQ(v.width(), 5);
+    ASSERT_EQ(v.height(), 4);
+    ASSERT_EQ(v.stride(), w);
+
+    //rows are contiguous and offset by the origin.
+    for (size_t y = 0; y < v.height(); ++y) {
+        auto const row = v.row(y);
+        ASSERT_EQ(row.size(), v.width());
+        for (size_t x = 0; x < row.size(); ++x) {
+            ASSERT_EQ(row[x], (g[{x + 2, y + 3}]));
+        }
+    }
+
+    //nested views compose their origins.
+    auto const nv = v.sub_view({1, 1}, 3, 2);
+    ASSERT_EQ((nv[{0, 0}]), (g[{3, 4}]));
+    ASSERT_EQ((nv[{2, 1}]), (g[{5, 5}]));
+
+    //iteration visits every element in order with view relative indicies.
+    auto n = 0;
+    for (auto const& i : nv) {
+        ASSERT_EQ(i.i.x, n % 3);
+        ASSERT_EQ(i.i.y, n / 3);
+        ASSERT_EQ(i.value, (g[{3 + i.i.x, 4 + i.i.y}]));
+        ++n;
+    }
+    ASSERT_EQ(n, nv.size());
+
+    //writes through a view are visible in the grid.
+    tez::const_grid_view<int> const cv = nv;
+    nv[{1, 1}] = -1;
+    ASSERT_EQ((cv[{1, 1}]), -1);
+    ASSERT_EQ((g[{4, 5}]), -1);
+
+    //empty views have no elements.
+    auto const ev = g.view({0, 0}, 0, 4);
+    ASSERT_TRUE(ev.begin() == ev.end());
+}
+
+TEST(Grid2d, RowsAndCursor) {
+    using grid = tez::grid2d<int>;
+
+    auto const w = 7;
+    auto const h = 5;
+
+    auto g = grid(w, h);
+    for (size_t y = 0; y < h; ++y) {
+        for (size_t x = 0; x < w; ++x) {
+            g[{x, y}] = static_cast<int>(y * w + x);
+        }
+    }
+
+    auto const& cg = g;
+
+    size_t y = 0;
+    for (auto const row : cg.rows()) {
+        ASSERT_EQ(row.y, y);
+        ASSERT_EQ(row.values.size(), w);
+        ASSERT_EQ(row.values.data(), &(cg[{0, y}]));
+        ++y;
+    }
+    ASSERT_EQ(y, h);
+
+    //random access still works with the incremental cursor.
+    auto it = cg.cbegin() + 17;
+    ASSERT_EQ(it->i.x, 17 % w);
+    ASSERT_EQ(it->i.y, 17 / w);
+    ASSERT_EQ(it->value, 17);
+
+    --it;
+    ASSERT_EQ(it->i.x, 16 % w);
+    ASSERT_EQ(it->value, 16);
+
+    it -= 10;
+    ASSERT_EQ(it->i.x, 6 % w);
+    ASSERT_EQ(it->i.y, 6 / w);
+    ASSERT_EQ(it->value, 6);
+
+    ASSERT_EQ(cg.cend() - cg.cbegin(), g.size());
+}
+
+TEST(Grid2d, DirtyTracking) {
+    using grid  = tez::grid2d<int>;
+    using index = grid::index;
+
+    auto g = grid(40, 20);
+    auto const& cg = g;
+
+    //disabled by default.
+    g[{1, 1}] = 1;
+    ASSERT_FALSE(g.is_tracking_dirty());
+    ASSERT_EQ(g.dirty().count(), 0);
+
+    g.enable_dirty_tracking(16); //3 x 2 blocks
+    ASSERT_TRUE(g.is_tracking_dirty());
+
+    //reads don't mark.
+    ASSERT_EQ((cg[{1, 1}]), 1);
+    ASSERT_EQ((g.get({1, 1})), 1);
+    for (auto const& i : cg) { (void)i; }
+    ASSERT_EQ(g.dirty().count(), 0);
+
+    //a non-const operator[] may be a write.
+    (void)g[{1, 1}];
+    ASSERT_EQ(g.dirty().count(), 1);
+    g.clear_dirty();
+
+    g.set({1, 1}, 4);
+    ASSERT_EQ((cg[{1, 1}]), 4);
+    ASSERT_TRUE(g.dirty().is_dirty({0, 0}));
+    ASSERT_EQ(g.dirty().count(), 1);
+    g.clear_dirty();
+
+    g[{17, 3}] = 2;
+    ASSERT_TRUE(g.dirty().is_dirty({16, 0}));
+    ASSERT_TRUE(g.dirty().is_dirty({31, 15}));
+    ASSERT_FALSE(g.dirty().is_dirty({0, 0}));
+    ASSERT_EQ(g.dirty().count(), 1);
+
+    //regions mark every block they overlap.
+    g.fill({30, 10}, 5, 8, 3);
+    ASSERT_EQ(g.dirty().count(), 4);
+
+    std::vector<std::tuple<size_t, size_t, size_t, size_t>> blocks;
+    g.dirty().for_each([&](index const i, size_t const w, size_t const h) {
+        blocks.emplace_back(i.x, i.y, w, h);
+    });
+
+    ASSERT_EQ(blocks.size(), 4);
+    ASSERT_EQ(blocks[0], std::make_tuple(16u, 0u, 16u, 16u));
+    ASSERT_EQ(blocks[1], std::make_tuple(32u, 0u, 8u, 16u));
+    ASSERT_EQ(blocks[2], std::make_tuple(16u, 16u, 16u, 4u));
+    ASSERT_EQ(blocks[3], std::make_tuple(32u, 16u, 8u, 4u));
+
+    g.clear_dirty();
+    ASSERT_EQ(g.dirty().count(), 0);
+
+    g.view({0, 16}, 2, 2);
+    ASSERT_EQ(g.dirty().count(), 1);
+    ASSERT_TRUE(g.dirty().is_dirty({0, 19}));
+
+    g.fill(0);
+    ASSERT_EQ(g.dirty().count(), 6);
+
+    g.disable_dirty_tracking();
+    ASSERT_EQ(g.dirty().count(), 0);
+}
+
+TEST(Grid2d, Blit) {
+    using grid = tez::grid2d<int>;
+
+    auto src = grid(4, 3);
+    for (auto const& i : src) {
+        i.value = static_cast<int>(i.i.y * 4 + i.i.x);
+    }
+
+    auto g = grid(10, 8, -1);
+    g.enable_dirty_tracking(4);
+
+    g.blit({5, 4}, src.view());
+    ASSERT_EQ(g.dirty().count(), 2);
+
+    //only even values.
+    g.blit({0, 0}, src.view(), [](int const v) { return v % 2 == 0; });
+
+    for (auto const& i : g) {
+        auto const x = i.i.x;
+        auto const y = i.i.y;
+
+        if (x >= 5 && x < 9 && y >= 4 && y < 7) {
+            ASSERT_EQ(i.value, (src[{x - 5, y - 4}]));
+        } else if (x < 4 && y < 3 && src[{x, y}] % 2 == 0) {
+            ASSERT_EQ(i.value, (src[{x, y}]));
+        } else {
+            ASSERT_EQ(i.value, -1);
+        }
+    }
+
+    //non trivially copyable types take the element-wise path.
+    auto strings = tez::grid2d<std::string>(3, 3, "a");
+    auto const one = tez::grid2d<std::string>(2, 1, "b");
+    strings.blit({1, 2}, one.view());
+    ASSERT_EQ((strings[{0, 2}]), "a");
+    ASSERT_EQ((strings[{1, 2}]), "b");
+    ASSERT_EQ((strings[{2, 2}]), "b");
+}
+
+//==============================================================================
+
+#include "game/tile_planes.hpp"
+
+TEST(TilePlanes, RoundTrip) {
+    using namespace tez;
+
+    auto const w = 9;
+    auto const h = 6;
+
+    auto src = grid2d<tile_data>(w, h);
+    for (auto const row : src.rows()) {
+        for (size_t x = 0; x < row.values.size(); ++x) {
+            auto& t = row.values[x];
+            t.type      = static_cast<tile_type>((x + row.y) % static_cast<size_t>(tile_type::COUNT));
+            t.data      = x * 1000 + row.y;
+            t.offset    = tile_data::offset_t {static_cast<uint16_t>(x), static_cast<uint16_t>(row.y)};
+            t.sub_type  = static_cast<uint16_t>(x + 1);
+            t.variation = static_cast<uint8_t>(row.y + 1);
+        }
+    }
+
+    auto planes = tile_planes {src};
+    ASSERT_EQ(planes.width(), w);
+    ASSERT_EQ(planes.height(), h);
+
+    //the type plane agrees with the source.
+    for (auto const row : planes.types().rows()) {
+        for (size_t x = 0; x < row.values.size(); ++x) {
+            ASSERT_EQ(row.values[x], (src[{x, row.y}].type));
+        }
+    }
+
+    //writes through the proxy land in every plane.
+    auto value = tile_data {tile_type::door};
+    value.data      = 42;
+    value.sub_type  = 7;
+    value.variation = 3;
+    planes[{4, 2}] = value;
+
+    ASSERT_EQ((planes.types()[{4, 2}]), tile_type::door);
+    ASSERT_EQ((planes.data()[{4, 2}]), 42u);
+    ASSERT_EQ((planes.sub_types()[{4, 2}]), 7u);
+    ASSERT_EQ((planes.variations()[{4, 2}]), 3u);
+
+    src[{4, 2}] = value;
+
+    auto const result = planes.to_grid();
+    for (auto const& tile : result) {
+        auto const& expected = src[tile.i];
+        ASSERT_EQ(expected.type,      tile.value.type);
+        ASSERT_EQ(expected.data,      tile.value.data);
+        ASSERT_EQ(expected.offset,    tile.value.offset);
+        ASSERT_EQ(expected.sub_type,  tile.value.sub_type);
+        ASSERT_EQ(expected.variation, tile.value.variation);
+    }
+}
+
 //==============================================================================
 
 #include "game/room.hpp"
@@ -100,13 +396,13 @@ TEST(Room, SimpleRoom) {
         ASSERT_GE(r.height(), min_h);
         ASSERT_LE(r.height(), max_h);
 
-        for (size_t y : {0u, r.height() - 1}) {
-            for (auto x = 0; x < r.width(); ++x)
+        for (size_t y : {size_t {0}, r.height() - 1}) {
+            for (size_t x = 0; x < r.width(); ++x)
                 ASSERT_EQ((r[{x, y}].type), tez::tile_type::wall);
         }
 
-        for (size_t x : {0u, r.width() - 1}) {
-            for (auto y = 0; y < r.height(); ++y)
+        for (size_t x : {size_t {0}, r.width() - 1}) {
+            for (size_t y = 0; y < r.height(); ++y)
                 ASSERT_EQ((r[{x, y}].type), tez::tile_type::wall);
         }
 
@@ -117,5 +413,481 @@ TEST(Room, SimpleRoom) {
     lay.normalize();
     ASSERT_TRUE(lay.verify());
 
+    auto const map = lay.to_grid();
+    for (size_t i = 0; i < lay.rects_.size(); ++i) {
+        auto const& r = lay.rects_[i];
+        auto const& room = lay.data_[i];
+
+        for (auto const& tile : room) {
+            auto const x = tile.i.x + r.left();
+            auto const y = tile.i.y + r.top();
+            ASSERT_EQ(tile.value.type, (map[{x, y}].type));
+        }
+    }
+
     }
 }
+
+//==============================================================================
+
+#include "game/bitboard.hpp"
+
+namespace {
+    //! Reference implementation of the 3x3 neighbourhood operations.
+    template <typename F>
+    bool naive_neighbourhood(tez::bitboard const& b, size_t x, size_t y, bool center, bool init, F f) {
+        auto result = init;
+
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (!center && dx == 0 && dy == 0) continue;
+
+                auto const xi = static_cast<size_t>(static_cast<int>(x) + dx);
+                auto const yi = static_cast<size_t>(static_cast<int>(y) + dy);
+                auto const v  = b.is_valid({xi, yi}) ? b[{xi, yi}] : false;
+
+                result = f(result, v);
+            }
+        }
+
+        return result;
+    }
+}
+
+TEST(Bitboard, NeighbourOperations) {
+    using namespace tez;
+
+    //straddle a word boundary.
+    auto const w = 70;
+    auto const h = 11;
+
+    std::mt19937 rand {7};
+    std::bernoulli_distribution coin {0.6};
+
+    auto src = grid2d<tile_data>(w, h);
+    for (auto const row : src.rows()) {
+        for (auto& t : row.values) {
+            t.type = coin(rand) ? tile_type::floor : tile_type::wall;
+        }
+    }
+
+    auto const b = bitboard {src, tile_property::passable};
+
+    //construction from the type plane gives the same result.
+    auto const planes = tile_planes {src};
+    auto const bp     = bitboard {planes.types(), tile_property::passable};
+
+    size_t n = 0;
+    for (auto const& t : src) {
+        auto const expected = (t.value.type == tile_type::floor);
+        ASSERT_EQ(expected, b[t.i]);
+        ASSERT_EQ(expected, bp[t.i]);
+        n += expected ? 1 : 0;
+    }
+    ASSERT_EQ(n, b.count());
+
+    auto const any_of = [](bool a, bool b) { return a || b; };
+    auto const all_of = [](bool a, bool b) { return a && b; };
+
+    auto const dilated = b.dilate();
+    auto const eroded  = b.erode();
+    auto const near    = b.any_neighbour();
+
+    for (size_t y = 0; y < h; ++y) {
+        for (size_t x = 0; x < w; ++x) {
+            ASSERT_EQ(naive_neighbourhood(b, x, y, true,  false, any_of), (dilated[{x, y}]));
+            ASSERT_EQ(naive_neighbourhood(b, x, y, true,  true,  all_of), (eroded[{x, y}]));
+            ASSERT_EQ(naive_neighbourhood(b, x, y, false, false, any_of), (near[{x, y}]));
+        }
+    }
+
+    //padding stays clear.
+    auto inv = b.clone();
+    inv.invert();
+    ASSERT_EQ(inv.count() + b.count(), b.size());
+}
+
+//==============================================================================
+
+#include "game/chunked_map.hpp"
+
+TEST(ChunkedMap, LazyAndEvict) {
+    using namespace tez;
+    using point = chunked_map::point;
+    using key   = chunked_map::chunk_key;
+
+    auto const n = static_cast<int>(chunked_map::chunk_size);
+
+    ASSERT_EQ(chunked_map::key_of(point {0, 0}),          (key {0, 0}));
+    ASSERT_EQ(chunked_map::key_of(point {n - 1, n}),      (key {0, 1}));
+    ASSERT_EQ(chunked_map::key_of(point {-1, -n}),        (key {-1, -1}));
+    ASSERT_EQ(chunked_map::key_of(point {-n - 1, 2 * n}), (key {-2, 2}));
+
+    int generated = 0;
+    std::vector<key> evicted;
+
+    //room for exactly 3 chunks.
+    chunked_map m {
+        3 * chunked_map::chunk_mem_size()
+      , [&](key, chunked_map::chunk& c) {
+            ++generated;
+            for (auto const row : c.rows()) {
+                for (auto& t : row.values) t.type = tile_type::floor;
+            }
+        }
+      , [&](key k, chunked_map::chunk&) { evicted.push_back(k); }
+    };
+
+    ASSERT_EQ(m.max_chunks(), 3);
+    ASSERT_EQ(m.find(point {0, 0}), nullptr);
+
+    m[point {0, 0}].type  = tile_type::wall;
+    m[point {-5, 0}].type = tile_type::wall;
+    m[point {0, n}].type  = tile_type::wall;
+    ASSERT_EQ(generated, 3);
+    ASSERT_EQ(m.resident_chunks(), 3);
+
+    //touch {0, 0} so that {-1, 0} is the least recently used.
+    ASSERT_EQ((m[point {1, 1}].type), tile_type::floor);
+    ASSERT_EQ((m[point {0, 0}].type), tile_type::wall);
+
+    m[point {10 * n, 10 * n}];
+    ASSERT_EQ(m.resident_chunks(), 3);
+    ASSERT_EQ(evicted.size(), 1);
+    ASSERT_EQ(evicted[0], (key {-1, 0}));
+    ASSERT_FALSE(m.is_resident(key {-1, 0}));
+    ASSERT_EQ(m.find(point {-5, 0}), nullptr);
+
+    //evicted chunks are regenerated.
+    ASSERT_EQ((m[point {-5, 0}].type), tile_type::floor);
+    ASSERT_EQ(generated, 5);
+    ASSERT_LE(m.mem_size(), sizeof(chunked_map) + 3 * chunked_map::chunk_mem_size());
+}
+
+TEST(ChunkedMap, WriteRooms) {
+    using namespace tez;
+
+    tez::random rand {42};
+    generator::room_simple gen {{3, 10}, {3, 10}};
+    generator::layout_random lay;
+
+    for (int i = 0; i < 100; ++i) {
+        lay.insert(rand, gen.generate(rand));
+    }
+
+    //no normalization required; negative coordinates are fine.
+    chunked_map m {std::numeric_limits<size_t>::max()};
+    lay.write_to(m);
+
+    for (size_t i = 0; i < lay.rects_.size(); ++i) {
+        auto const& r = lay.rects_[i];
+        for (auto const& tile : lay.data_[i]) {
+            auto const x = static_cast<int>(tile.i.x) + r.left();
+            auto const y = static_cast<int>(tile.i.y) + r.top();
+            ASSERT_EQ(tile.value.type, (m[chunked_map::point {x, y}].type));
+        }
+    }
+
+    //only non-empty tiles are stamped; the empty ones may overlap.
+    grid2d<tile_data> ring {3, 3, tile_data {tile_type::wall}};
+    ring[{1, 1}] = tile_data {tile_type::empty};
+
+    //well clear of the rooms.
+    chunked_map::rect const at {-1001, -1001, -998, -998};
+    m[chunked_map::point {-1000, -1000}].type = tile_type::floor;
+    m.write(ring, at);
+
+    ASSERT_EQ((m[chunked_map::point {-1000, -1000}].type), tile_type::floor);
+    ASSERT_EQ((m[chunked_map::point {-1001, -999}].type),  tile_type::wall);
+}
+
+TEST(Bitboard, CellularAutomaton) {
+    using namespace tez;
+
+    auto const w = 130;
+    auto const h = 9;
+
+    std::mt19937 rand {11};
+    std::bernoulli_distribution coin {0.5};
+
+    auto b = bitboard {w, h};
+    for (size_t y = 0; y < h; ++y) {
+        for (size_t x = 0; x < w; ++x) {
+            b.set({x, y}, coin(rand));
+        }
+    }
+
+    auto const rule = ca_rule::cave();
+    auto out = bitboard {w, h};
+
+    for (auto const outside : {false, true}) {
+        b.step(rule, out, outside);
+
+        for (size_t y = 0; y < h; ++y) {
+            for (size_t x = 0; x < w; ++x) {
+                unsigned n = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        if (dx == 0 && dy == 0) continue;
+
+                        auto const xi = static_cast<size_t>(static_cast<int>(x) + dx);
+                        auto const yi = static_cast<size_t>(static_cast<int>(y) + dy);
+                        n += (b.is_valid({xi, yi}) ? b[{xi, yi}] : outside) ? 1 : 0;
+                    }
+                }
+
+                auto const mask = b[{x, y}] ? rule.survive : rule.birth;
+                ASSERT_EQ(((mask >> n) & 1) != 0, (out[{x, y}]));
+            }
+        }
+
+        //padding stays clear.
+        auto inv = out.clone();
+        inv.invert();
+        ASSERT_EQ(inv.count() + out.count(), out.size());
+    }
+}
+
+TEST(Room, Cave) {
+    using namespace tez;
+
+    auto const gen = generator::room_cave {80, 50};
+
+    tez::random rand_a {3};
+    tez::random rand_b {3};
+    auto const a = gen.generate(rand_a);
+    auto const b = gen.generate(rand_b);
+
+    size_t floor = 0;
+    for (auto const& t : a) {
+        ASSERT_EQ(t.value.type, b[t.i].type);
+
+        auto const edge = t.i.x == 0 || t.i.y == 0 || t.i.x == a.width() - 1 || t.i.y == a.height() - 1;
+        if (edge) {
+            ASSERT_NE(t.value.type, tile_type::floor);
+        }
+
+        floor += (t.value.type == tile_type::floor) ? 1 : 0;
+    }
+
+    ASSERT_GT(floor, 0);
+    ASSERT_LT(floor, a.size());
+}
+
+TEST(Room, Store) {
+    using namespace tez;
+
+    generator::room_simple gen {{3, 10}, {3, 10}};
+
+    tez::random rand_a {21};
+    tez::random rand_b {21};
+
+    room_store store;
+    store.reserve(50, 50 * 10 * 10);
+
+    //nothing is moved after the reserve.
+    auto const first = gen.generate(rand_a, store).data();
+
+    std::vector<room> rooms;
+    rooms.push_back(gen.generate(rand_b));
+
+    for (int i = 1; i < 50; ++i) {
+        gen.generate(rand_a, store);
+        rooms.push_back(gen.generate(rand_b));
+    }
+
+    //the same rooms in a single buffer.
+    ASSERT_EQ(store.size(), 50);
+    for (size_t i = 0; i < store.size(); ++i) {
+        auto const v = store[i];
+        ASSERT_EQ(v.width(), rooms[i].width());
+        ASSERT_EQ(v.height(), rooms[i].height());
+
+        if (i > 0) {
+            auto const prev = store[i - 1];
+            ASSERT_EQ(v.data(), prev.data() + prev.size());
+        }
+
+        for (auto const& t : v) {
+            ASSERT_EQ(t.value.type, rooms[i][t.i].type);
+        }
+    }
+
+    ASSERT_EQ(store[0].data(), first);
+
+    auto const tiles = store.tile_count();
+    auto const last  = store[49].size();
+    store.pop_back();
+    ASSERT_EQ(store.size(), 49);
+    ASSERT_EQ(store.tile_count(), tiles - last);
+
+    //generating in place gives the same layout as inserting copies.
+    generator::layout_random lay_a;
+    generator::layout_random lay_b;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(lay_a.try_generate(rand_a, gen));
+        ASSERT_TRUE(lay_b.try_insert(rand_b, gen.generate(rand_b)));
+    }
+
+    lay_a.normalize();
+    lay_b.normalize();
+
+    auto const map_a = lay_a.to_grid();
+    auto const map_b = lay_b.to_grid();
+    ASSERT_EQ(map_a.width(), map_b.width());
+    ASSERT_EQ(map_a.height(), map_b.height());
+    for (auto const& t : map_a) {
+        ASSERT_EQ(t.value.type, map_b[t.i].type);
+    }
+}
+
+TEST(Room, BudgetedPlacement) {
+    using namespace tez;
+    using generator::placement_budget;
+    using generator::placement_stats;
+
+    tez::random rand {7};
+    generator::room_simple gen {{3, 10}, {3, 10}};
+    generator::layout_random lay;
+
+    for (int i = 0; i < 200; ++i) {
+        ASSERT_TRUE(lay.try_insert(rand, gen.generate(rand)));
+    }
+
+    ASSERT_EQ(lay.stats_.size(), 200);
+    ASSERT_EQ(lay.stats_[0].attempts, 0);
+
+    for (auto const& s : lay.stats_) {
+        ASSERT_TRUE(s.placed);
+        ASSERT_LE(s.rejections, s.corrections);
+        ASSERT_LE(s.corrections, s.attempts);
+    }
+
+    //a single attempt is often not enough; a failure leaves the room with
+    //the caller.
+    size_t failed = 0;
+    for (int i = 0; i < 100; ++i) {
+        auto r = gen.generate(rand);
+        auto const w = r.width();
+        auto const n = lay.rects_.size();
+
+        if (!lay.try_insert(rand, std::move(r), placement_budget {1})) {
+            ASSERT_EQ(r.width(), w);
+            ASSERT_EQ(lay.rects_.size(), n);
+            ASSERT_FALSE(lay.stats_.back().placed);
+            ++failed;
+        }
+
+        ASSERT_EQ(lay.stats_.back().attempts, 1);
+    }
+
+    ASSERT_GT(failed, 0);
+    ASSERT_EQ(lay.rects_.size(), 300 - failed);
+    ASSERT_TRUE(lay.verify());
+
+    auto const buckets = placement_stats::histogram(lay.stats_, &placement_stats::attempts);
+    ASSERT_EQ(std::accumulate(std::begin(buckets), std::end(buckets), size_t {0}), 300);
+    ASSERT_GE(buckets[1], 100);
+    ASSERT_GE(buckets[0], 1); //the first room needs no attempts.
+
+    std::ostringstream out;
+    placement_stats::write_histogram(out, buckets);
+    ASSERT_EQ(out.str().substr(0, 4), "0,0,");
+}
+
+TEST(Room, BspLayout) {
+    using namespace tez;
+
+    generator::room_simple gen {{3, 12}, {3, 12}};
+    generator::layout_bsp a {200, 120};
+    generator::layout_bsp b {200, 120};
+
+    tez::random rand_a {11};
+    tez::random rand_b {11};
+    a.generate(rand_a, gen);
+    b.generate(rand_b, gen);
+
+    auto const n = a.rects_.size();
+    ASSERT_GT(n, 20);
+    ASSERT_EQ(n, b.rects_.size());
+    ASSERT_TRUE(bklib::intersecting_pairs(a.rects_).empty());
+
+    //each room lies strictly inside its leaf.
+    for (auto const& node : a.nodes_) {
+        if (node.room < 0) continue;
+
+        auto const& r = a.rects_[node.room];
+        ASSERT_TRUE(r == b.rects_[node.room]);
+        ASSERT_GT(r.left(), node.area.left());
+        ASSERT_GT(r.top(), node.area.top());
+        ASSERT_LT(r.right(), node.area.right());
+        ASSERT_LT(r.bottom(), node.area.bottom());
+    }
+
+    //the links span every room.
+    auto const links = a.links();
+    ASSERT_EQ(links.size(), n - 1);
+
+    std::vector<size_t> parent(n);
+    for (size_t i = 0; i < n; ++i) parent[i] = i;
+
+    auto const find = [&](size_t i) {
+        while (parent[i] != i) i = parent[i];
+        return i;
+    };
+
+    for (auto const& l : links) {
+        parent[find(l.first)] = find(l.second);
+    }
+
+    for (size_t i = 1; i < n; ++i) {
+        ASSERT_EQ(find(0), find(i));
+    }
+}
+
+#include "game/spatial_hash.hpp"
+
+TEST(SpatialHash, MatchesLinearScan) {
+    using rect = tez::spatial_hash::rect;
+
+    std::mt19937 rand {5};
+    std::uniform_int_distribution<int> pos  {-100, 100};
+    std::uniform_int_distribution<int> size {1, 40};
+
+    auto const random_rect = [&] {
+        auto const x = pos(rand);
+        auto const y = pos(rand);
+        auto const w = size(rand);
+        auto const h = size(rand);
+        return rect {x, y, x + w, y + h};
+    };
+
+    tez::spatial_hash index {8};
+    std::vector<rect> rects;
+
+    for (int i = 0; i < 200; ++i) {
+        auto const r = random_rect();
+        ASSERT_EQ(index.insert(r), rects.size());
+        rects.push_back(r);
+    }
+
+    std::vector<tez::spatial_hash::id_t> found;
+    for (int i = 0; i < 200; ++i) {
+        auto const q = random_rect();
+
+        std::vector<tez::spatial_hash::id_t> expected;
+        for (size_t j = 0; j < rects.size(); ++j) {
+            if (bklib::intersects(q, rects[j])) {
+                expected.push_back(static_cast<tez::spatial_hash::id_t>(j));
+            }
+        }
+
+        index.query(q, found);
+        ASSERT_EQ(expected, found);
+        ASSERT_EQ(!expected.empty(), index.any_intersecting(q));
+    }
+
+    index.clear();
+    ASSERT_EQ(index.size(), 0);
+    ASSERT_FALSE(index.any_intersecting(rects[0]));
+}
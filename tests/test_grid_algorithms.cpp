@@ -0,0 +1,70 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "game/grid2d.hpp"
+#include "game/grid_algorithms.hpp"
+
+TEST(GridAlgorithms, MatchSerial) {
+    auto const w = 37;
+    auto const h = 101;
+
+    auto src = tez::grid2d<int>(w, h);
+    for (auto const& i : src) {
+        i.value = static_cast<int>((i.i.y * 31 + i.i.x * 17) % 23) - 11;
+    }
+
+    auto serial_sum   = 0.0f;
+    auto serial_count = size_t {0};
+    for (auto const& i : src) {
+        serial_sum   += i.value * 0.1f;
+        serial_count += (i.value > 0) ? 1 : 0;
+    }
+
+    float first_sum = 0.0f;
+
+    for (size_t threads = 1; threads <= 4; ++threads) {
+        bklib::thread_pool pool {threads};
+
+        auto dest = tez::grid2d<int>(w, h);
+        tez::transform(pool, src, dest, [](int const v) { return v * 2; });
+        for (auto const& i : src) {
+            ASSERT_EQ(dest[i.i], i.value * 2);
+        }
+
+        ASSERT_EQ(tez::count_if(pool, src, [](int const v) { return v > 0; }), serial_count);
+
+        //floating point results are identical for any number of threads.
+        auto const sum = tez::reduce(pool, src, 0.0f
+          , [](float const a, int const v) { return a + v * 0.1f; }
+          , [](float const a, float const b) { return a + b; }
+        );
+
+        if (threads == 1) {
+            first_sum = sum;
+        }
+
+        ASSERT_EQ(sum, first_sum);
+        ASSERT_NEAR(sum, serial_sum, 0.1f);
+
+        //bool results are written per band without sharing storage.
+        auto const all_in_range = tez::reduce(pool, src, true
+          , [](bool const a, int const v) { return a && v >= -11 && v <= 11; }
+          , [](bool const a, bool const b) { return a && b; }
+        );
+        auto const any_odd = tez::reduce(pool, src, false
+          , [](bool const a, int const v) { return a || (v % 2 != 0); }
+          , [](bool const a, bool const b) { return a || b; }
+        );
+        ASSERT_TRUE(all_in_range);
+        ASSERT_TRUE(any_odd);
+
+        //rows of a sub view.
+        tez::parallel_for_rows(pool, dest.view({1, 2}, 10, 20), [&](tez::grid_row<int> const row) {
+            for (auto& v : row.values) { v = 0; }
+        });
+        for (auto const& i : dest) {
+            auto const inside = i.i.x >= 1 && i.i.x < 11 && i.i.y >= 2 && i.i.y < 22;
+            ASSERT_EQ(i.value, inside ? 0 : src[i.i] * 2);
+        }
+    }
+}
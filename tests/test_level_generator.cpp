@@ -0,0 +1,44 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "game/level_generator.hpp"
+
+TEST(LevelGenerator, BatchIsReproducible) {
+    using namespace tez;
+
+    level_generator::params p;
+    p.room_count = 12;
+
+    auto const gen = level_generator {p};
+
+    uint64_t const seed = 1234;
+    size_t   const n    = 6;
+
+    auto const equal = [](level_generator::level const& a, level_generator::level const& b) {
+        if (a.width() != b.width() || a.height() != b.height()) return false;
+
+        for (auto const& i : a) {
+            if (i.value.type != b[i.i].type) return false;
+        }
+
+        return true;
+    };
+
+    std::vector<level_generator::level> serial;
+    for (size_t i = 0; i < n; ++i) {
+        serial.push_back(gen.generate(seed, 10 + i));
+    }
+
+    //streams differ.
+    ASSERT_FALSE(equal(serial[0], serial[1]));
+
+    for (size_t threads = 1; threads <= 3; ++threads) {
+        bklib::thread_pool pool {threads};
+        auto const batch = gen.generate_batch(pool, seed, 10, n);
+
+        ASSERT_EQ(batch.size(), n);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_TRUE(equal(serial[i], batch[i]));
+        }
+    }
+}
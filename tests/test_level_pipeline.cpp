@@ -0,0 +1,42 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "game/level_generator.hpp"
+#include "game/level_pipeline.hpp"
+
+#include <thread>
+
+TEST(LevelPipeline, MatchesGenerator) {
+    using namespace tez;
+
+    level_generator::params p;
+    p.room_count = 8;
+
+    auto const gen = level_generator {p};
+    level_pipeline pipeline {gen, 77, 5};
+
+    ASSERT_EQ(pipeline.pending_index(), 5);
+
+    auto const first = pipeline.take();
+    ASSERT_EQ(pipeline.pending_index(), 6);
+
+    //poll without blocking until the next level is ready.
+    level_pipeline::level second {0, 0};
+    while (!pipeline.try_take(second)) {
+        std::this_thread::yield();
+    }
+    ASSERT_EQ(pipeline.pending_index(), 7);
+
+    auto const expected_first  = gen.generate(77, 5);
+    auto const expected_second = gen.generate(77, 6);
+
+    ASSERT_EQ(first.width(),  expected_first.width());
+    ASSERT_EQ(second.width(), expected_second.width());
+
+    for (auto const& i : first) {
+        ASSERT_EQ(i.value.type, expected_first[i.i].type);
+    }
+    for (auto const& i : second) {
+        ASSERT_EQ(i.value.type, expected_second[i.i].type);
+    }
+}
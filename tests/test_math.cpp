@@ -211,3 +211,58 @@ TEST(Math, AARectIntersectionsInvalid) {
     ASSERT_FALSE(intersects(r, r2));
     ASSERT_FALSE(intersects(r, r3));
 }
+
+//==============================================================================
+// Sweep and prune against every pair.
+//==============================================================================
+TEST(Math, AARectIntersectingPairs) {
+    using namespace bklib;
+
+    using rect = axis_aligned_rect<int>;
+
+    std::mt19937 rand {3};
+    std::uniform_int_distribution<int> pos  {-50, 50};
+    std::uniform_int_distribution<int> size {1, 15};
+
+    std::vector<rect> rects;
+    for (int i = 0; i < 300; ++i) {
+        auto const x = pos(rand);
+        auto const y = pos(rand);
+        auto const w = size(rand);
+        auto const h = size(rand);
+        rects.push_back(rect {x, y, x + w, y + h});
+    }
+
+    //long rects spanning many others, in both directions.
+    rects.push_back(rect {-40, -60, -37, 60});
+    rects.push_back(rect {-60, 20, 60, 22});
+
+    std::vector<std::pair<size_t, size_t>> expected;
+    for (size_t i = 0; i < rects.size(); ++i) {
+        for (auto j = i + 1; j < rects.size(); ++j) {
+            if (intersects(rects[i], rects[j])) {
+                expected.emplace_back(i, j);
+            }
+        }
+    }
+
+    auto actual = intersecting_pairs(rects);
+    std::sort(std::begin(actual), std::end(actual));
+
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected, actual);
+
+    //touching edges don't intersect.
+    std::vector<rect> const tiles = {{0, 0, 1, 1}, {1, 0, 2, 1}, {0, 1, 1, 2}};
+    ASSERT_TRUE(intersecting_pairs(tiles).empty());
+
+    ASSERT_TRUE(any_intersecting_pair(std::begin(rects), std::end(rects)));
+    ASSERT_FALSE(any_intersecting_pair(std::begin(tiles), std::end(tiles)));
+
+    //stops at the first pair.
+    size_t calls = 0;
+    ASSERT_TRUE(for_each_intersecting_pair_until(std::begin(rects), std::end(rects)
+      , [&](size_t, size_t) { return ++calls == 3; }
+    ));
+    ASSERT_EQ(3u, calls);
+}
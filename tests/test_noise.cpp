@@ -0,0 +1,69 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "game/grid2d.hpp"
+#include "game/noise.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+TEST(Noise, DeterministicAndVectorizedMatchesScalar) {
+    using namespace tez;
+
+    noise_params p;
+    p.octaves   = 5;
+    p.frequency = 1.0f / 17.0f;
+
+    auto const a = simplex_noise {1234};
+    auto const b = simplex_noise {1234};
+    auto const c = simplex_noise {4321};
+
+    //odd sizes exercise the scalar tail of each vectorized row.
+    grid2d<float> va {67, 23};
+    grid2d<float> vb {67, 23};
+    grid2d<float> vc {67, 23};
+    grid2d<float> sa {67, 23};
+
+    a.fill(va, p, -40.0f, 12.5f);
+    b.fill(vb, p, -40.0f, 12.5f);
+    c.fill(vc, p, -40.0f, 12.5f);
+    a.fill(sa, p, -40.0f, 12.5f, false);
+
+    size_t differ = 0;
+    for (size_t y = 0; y < va.height(); ++y) {
+        for (size_t x = 0; x < va.width(); ++x) {
+            auto const v = va[{x, y}];
+            ASSERT_GE(v, -1.0f);
+            ASSERT_LE(v,  1.0f);
+
+            ASSERT_EQ(0, std::memcmp(&v, &vb[{x, y}], sizeof(float)));
+            ASSERT_EQ(0, std::memcmp(&v, &sa[{x, y}], sizeof(float)));
+
+            auto const single = a.at(-40.0f + static_cast<float>(x), 12.5f + static_cast<float>(y), p);
+            ASSERT_EQ(0, std::memcmp(&v, &single, sizeof(float)));
+
+            differ += (v != vc[{x, y}]) ? 1 : 0;
+        }
+    }
+
+    ASSERT_GT(differ, va.size() / 2);
+
+    //a byte plane is the same field mapped onto [0, 255].
+    grid2d<uint8_t> bytes {67, 23};
+    a.fill(bytes, p, -40.0f, 12.5f);
+
+    std::vector<size_t> histogram(256);
+    for (size_t y = 0; y < bytes.height(); ++y) {
+        for (size_t x = 0; x < bytes.width(); ++x) {
+            auto const actual   = bytes[{x, y}];
+            auto const expected = static_cast<int>((va[{x, y}] + 1.0f) * 127.5f + 0.5f);
+            ASSERT_EQ(expected, actual);
+            ++histogram[actual];
+        }
+    }
+
+    //smooth noise covers a good part of the range.
+    auto const used = std::count_if(std::begin(histogram), std::end(histogram)
+      , [](size_t const n) { return n > 0; });
+    ASSERT_GT(used, 64);
+}
@@ -0,0 +1,284 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "timing_wheel.hpp"
+#include "timekeeper.hpp"
+#include "fixed_timestep.hpp"
+
+#include <map>
+#include <memory>
+#include <random>
+
+//==============================================================================
+// timing_wheel against a multimap of due ticks.
+//==============================================================================
+TEST(TimingWheel, MatchesReference) {
+    using wheel  = bklib::timing_wheel;
+    using id_t   = wheel::id_t;
+    using tick_t = wheel::tick_t;
+
+    id_t const IDS = 512;
+
+    std::mt19937 rand {42};
+    std::uniform_int_distribution<id_t> random_id {0, IDS - 1};
+
+    //mostly near, some across every level and some beyond the last.
+    auto const random_delay = [&]() -> tick_t {
+        auto const bits = std::uniform_int_distribution<int> {0, 28}(rand);
+        return std::uniform_int_distribution<tick_t> {0, (tick_t {1} << bits)}(rand);
+    };
+
+    wheel w;
+    std::vector<tick_t> due(IDS, 0);
+    std::vector<bool>   scheduled(IDS, false);
+    size_t count = 0;
+
+    auto const schedule = [&](id_t const id, tick_t const when) {
+        w.insert(id, when);
+        due[id] = std::max(when, w.now() + 1);
+        scheduled[id] = true;
+        ++count;
+    };
+
+    for (int round = 0; round < 1000; ++round) {
+        for (int i = 0; i < 16; ++i) {
+            auto const id = random_id(rand);
+            if (scheduled[id]) {
+                w.remove(id);
+                scheduled[id] = false;
+                --count;
+            } else {
+                schedule(id, w.now() + random_delay());
+            }
+        }
+
+        ASSERT_EQ(count, w.size());
+
+        std::multimap<tick_t, id_t> expected;
+        for (id_t id = 0; id < IDS; ++id) {
+            if (!scheduled[id]) continue;
+            ASSERT_TRUE(w.contains(id));
+            ASSERT_EQ(due[id], w.due(id));
+            expected.emplace(due[id], id);
+        }
+
+        auto const to = w.now() + random_delay();
+        tick_t last = 0;
+
+        w.advance(to, [&](id_t const id) {
+            ASSERT_TRUE(scheduled[id]);
+            ASSERT_FALSE(w.contains(id));
+            ASSERT_EQ(w.now(), due[id]);
+            ASSERT_LE(last, due[id]);
+
+            last = due[id];
+            scheduled[id] = false;
+            --count;
+
+            //reschedule some from within the callback.
+            if (id % 3 == 0) schedule(id, w.now() + random_delay());
+        });
+
+        ASSERT_EQ(to, w.now());
+
+        for (auto const& e : expected) {
+            if (e.first > to) break;
+            //expired, or expired and rescheduled.
+            ASSERT_TRUE(!scheduled[e.second] || due[e.second] > e.first);
+        }
+    }
+}
+
+//==============================================================================
+// timekeeper periods, driven by explicit times.
+//==============================================================================
+TEST(Timekeeper, FiresEachPeriod) {
+    using tk = bklib::timekeeper;
+    using std::chrono::milliseconds;
+
+    tk time {milliseconds(1)};
+    auto const start = time.now();
+
+    int fast = 0;
+    int slow = 0;
+    int late = 0;
+
+    time.register_event(milliseconds(10), [&](tk::delta const dt) {
+        ++fast;
+        ASSERT_GE(dt.count(), 10.0);
+    });
+
+    time.register_event(milliseconds(250), [&](tk::delta) { ++slow; });
+
+    time.register_event(milliseconds(40), [&](tk::delta) {
+        //events registered while firing start from the current update.
+        if (late++ == 0) {
+            time.register_event(milliseconds(5), [&](tk::delta) { ++late; });
+        }
+    });
+
+    ASSERT_EQ(3u, time.size());
+
+    for (int ms = 1; ms <= 1000; ++ms) {
+        time.update(start + milliseconds(ms));
+    }
+
+    ASSERT_EQ(4u, time.size());
+    ASSERT_EQ(100, fast);
+    ASSERT_EQ(4, slow);
+    //25 of the 40ms event, 192 of the 5ms event registered at 40ms.
+    ASSERT_EQ(25 + 192, late);
+
+    //a long stall fires each event once, with the whole elapsed time.
+    time.register_event(milliseconds(500), [&](tk::delta const dt) {
+        ASSERT_DOUBLE_EQ(10000.0 + 500.0, dt.count());
+    });
+
+    time.update(start + milliseconds(1000 + 500 + 10000));
+    ASSERT_EQ(101, fast);
+    ASSERT_EQ(5, slow);
+}
+
+//==============================================================================
+// timekeeper cancel, pause, resume and set_period.
+//==============================================================================
+TEST(Timekeeper, HandlesAndReuse) {
+    using tk = bklib::timekeeper;
+    using std::chrono::milliseconds;
+
+    tk time {milliseconds(1)};
+    auto const start = time.now();
+    auto const at = [&](int const ms) { time.update(start + milliseconds(ms)); };
+
+    int a = 0;
+    int b = 0;
+    int c = 0;
+
+    auto const ha = time.register_event(milliseconds(10), [&](tk::delta) { ++a; });
+    auto const hb = time.register_event(milliseconds(10), [&](tk::delta) { ++b; });
+
+    at(10);
+    ASSERT_EQ(1, a);
+    ASSERT_EQ(1, b);
+
+    //cancelled events stop; their handles go stale.
+    ASSERT_TRUE(time.cancel(ha));
+    ASSERT_FALSE(time.cancel(ha));
+    ASSERT_FALSE(time.contains(ha));
+    ASSERT_EQ(1u, time.size());
+
+    //the slot is reused; the stale handle doesn't affect the new event.
+    auto const hc = time.register_event(milliseconds(10), [&](tk::delta) { ++c; });
+    ASSERT_EQ(ha.id, hc.id);
+    ASSERT_NE(ha.generation, hc.generation);
+    ASSERT_FALSE(time.pause(ha));
+    ASSERT_FALSE(time.cancel(ha));
+
+    //paused at 14 with 6ms left; resumed at 30, due at 36.
+    at(14);
+    ASSERT_TRUE(time.pause(hb));
+    ASSERT_TRUE(time.is_paused(hb));
+    at(20);
+    at(30);
+    ASSERT_EQ(1, b);
+    ASSERT_EQ(2, c);
+    ASSERT_TRUE(time.resume(hb));
+    at(35);
+    ASSERT_EQ(1, b);
+    at(36);
+    ASSERT_EQ(2, b);
+
+    //a new period starts from the last update.
+    ASSERT_TRUE(time.set_period(hc, milliseconds(100)));
+    at(135);
+    ASSERT_EQ(2, c);
+    at(136);
+    ASSERT_EQ(3, c);
+
+    ASSERT_EQ(1, a);
+    ASSERT_EQ(2u, time.size());
+}
+
+TEST(Timekeeper, ShortLivedEventsReuseSlots) {
+    using tk = bklib::timekeeper;
+    using std::chrono::milliseconds;
+
+    tk time {milliseconds(1)};
+    auto const start = time.now();
+
+    int fired = 0;
+    uint32_t max_id = 0;
+
+    //one-shot events which cancel themselves, some registering another.
+    std::function<void (int)> spawn = [&](int const depth) {
+        auto const h = std::make_shared<tk::handle>();
+        *h = time.register_event(milliseconds(1 + depth % 7), [&, h, depth](tk::delta) {
+            ++fired;
+            ASSERT_TRUE(time.cancel(*h));
+            if (depth % 2 == 0) spawn(depth + 1);
+        });
+
+        max_id = std::max(max_id, h->id);
+    };
+
+    for (int ms = 1; ms <= 2000; ++ms) {
+        for (int i = 0; i < 8; ++i) spawn(i);
+        time.update(start + milliseconds(ms));
+    }
+
+    ASSERT_LT(0, fired);
+    //bounded by the events live at once, not by the number registered.
+    ASSERT_GT(256u, max_id);
+    ASSERT_GT(256u, time.size());
+}
+
+TEST(Timekeeper, SubMillisecondDelta) {
+    using tk = bklib::timekeeper;
+    using std::chrono::microseconds;
+
+    tk time {microseconds(100)};
+    auto const start = time.now();
+
+    double last = 0.0;
+    time.register_event(microseconds(2500), [&](tk::delta const dt) { last = dt.count(); });
+
+    time.update(start + microseconds(2400));
+    ASSERT_DOUBLE_EQ(0.0, last);
+    time.update(start + microseconds(2700));
+    ASSERT_DOUBLE_EQ(2.7, last);
+}
+
+//==============================================================================
+// fixed_timestep catch up, dropping and alpha.
+//==============================================================================
+TEST(FixedTimestep, CatchUpAndAlpha) {
+    using std::chrono::milliseconds;
+
+    bklib::fixed_timestep sim {milliseconds(10), 4};
+    auto const start = sim.simulation().now();
+
+    int ticks = 0;
+    double simulated = 0.0;
+    sim.simulation().register_event(milliseconds(10), [&](bklib::timekeeper::delta const dt) {
+        ++ticks;
+        simulated += dt.count();
+    });
+
+    ASSERT_EQ(0u, sim.update(start + milliseconds(5)));
+    ASSERT_DOUBLE_EQ(0.5, sim.alpha());
+
+    ASSERT_EQ(2u, sim.update(start + milliseconds(27)));
+    ASSERT_EQ(2, ticks);
+    ASSERT_NEAR(0.7, sim.alpha(), 1e-9);
+
+    //a long frame runs at most 4 steps; whole steps beyond that are dropped.
+    ASSERT_EQ(4u, sim.update(start + milliseconds(1000 + 3)));
+    ASSERT_EQ(6, ticks);
+    ASSERT_NEAR(0.3, sim.alpha(), 1e-9);
+    ASSERT_EQ(milliseconds(1000 - 60), sim.dropped());
+
+    //each step advances the simulation by exactly one step.
+    ASSERT_EQ(6u, sim.steps());
+    ASSERT_DOUBLE_EQ(60.0, simulated);
+    ASSERT_EQ(start + milliseconds(60), sim.simulation().now());
+}
@@ -0,0 +1,125 @@
+#include "pch.hpp"
+
+#include <gtest/gtest.h>
+#include "game/grid2d.hpp"
+#include "game/wfc.hpp"
+
+#include <cstring>
+
+namespace {
+
+using tez::grid2d;
+using tez::tile_data;
+using tez::tile_type;
+using tez::generator::wfc;
+
+//! A small room against a corridor; tight enough to need backtracking.
+grid2d<tile_data> make_sample() {
+    char const* const sample_rows[] = {
+        "#.#####."
+      , "#.#...#."
+      , "#.+...#."
+      , "#.#...#."
+      , "#.##+##."
+      , "#......."
+      , "#......."
+      , "########"
+    };
+
+    auto const to_type = [](char const c) {
+        return c == '#' ? tile_type::wall
+             : c == '+' ? tile_type::door
+                        : tile_type::floor;
+    };
+
+    grid2d<tile_data> sample {8, 8};
+    for (size_t y = 0; y < 8; ++y) {
+        for (size_t x = 0; x < 8; ++x) {
+            sample[{x, y}] = tile_data {to_type(sample_rows[y][x])};
+        }
+    }
+
+    return sample;
+}
+
+bool same(tile_data const& l, tile_data const& r) {
+    return std::memcmp(&l, &r, sizeof(tile_data)) == 0;
+}
+
+//! @returns Whether every n x n window of @c out is one of the patterns of
+//! @c model.
+bool is_made_of_patterns(wfc const& model, unsigned const n, grid2d<tile_data> const& out) {
+    for (size_t y = 0; y + n <= out.height(); ++y) {
+        for (size_t x = 0; x + n <= out.width(); ++x) {
+            auto found = false;
+            for (size_t p = 0; p < model.pattern_count() && !found; ++p) {
+                found = true;
+                for (unsigned j = 0; j < n && found; ++j) {
+                    for (unsigned i = 0; i < n && found; ++i) {
+                        found = same(out[{x + i, y + j}], model.tile(p, i, j));
+                    }
+                }
+            }
+
+            if (!found) return false;
+        }
+    }
+
+    return true;
+}
+
+} //namespace
+
+TEST(Wfc, OutputIsMadeOfSamplePatterns) {
+    auto const model = wfc {make_sample(), 3};
+    ASSERT_GT(model.pattern_count(), 0);
+    ASSERT_LE(model.pattern_count(), 64);
+
+    //east and west agree with each other.
+    for (size_t p = 0; p < model.pattern_count(); ++p) {
+        model.compatible(1, p).for_each([&](size_t const q) {
+            ASSERT_TRUE(model.compatible(0, q).test(p));
+        });
+    }
+
+    auto const generate = [&](unsigned const seed) {
+        tez::random rand {seed};
+        grid2d<tile_data> out {40, 30};
+        EXPECT_TRUE(model.generate(rand, out, 50));
+        return out;
+    };
+
+    auto const a = generate(3);
+    auto const b = generate(3);
+
+    for (size_t y = 0; y < a.height(); ++y) {
+        for (size_t x = 0; x < a.width(); ++x) {
+            ASSERT_TRUE(same(a[{x, y}], b[{x, y}]));
+        }
+    }
+
+    ASSERT_TRUE(is_made_of_patterns(model, 3, a));
+}
+
+TEST(Wfc, EverySuccessIsConsistent) {
+    auto const sample = make_sample();
+
+    //cells collapsing together in one wave must still be checked against
+    //each other; a failure is rare per seed, so try many.
+    for (unsigned const n : {2u, 3u}) {
+        auto const model = wfc {sample, n};
+
+        size_t succeeded = 0;
+        for (unsigned seed = 0; seed < 150; ++seed) {
+            tez::random rand {seed};
+            grid2d<tile_data> out {64, 64};
+
+            if (!model.generate(rand, out, 1)) continue;
+            ++succeeded;
+
+            ASSERT_TRUE(is_made_of_patterns(model, n, out)) << "n = " << n << ", seed = " << seed;
+        }
+
+        ASSERT_GT(succeeded, 0u);
+    }
+}